@@ -102,7 +102,7 @@ void MainWindow::createProperties()
         group->setBackgroundColor(Qt::darkGray);
         group->setTitle("information");
         group->setMenuVisible(true);
-        connect(group, SIGNAL(signalPopupMenu(QtProperty*)), this, SLOT(onPopupMenu(QtProperty*)));
+        connect(group->getNotifier(), SIGNAL(signalPopupMenu(QtProperty*)), this, SLOT(onPopupMenu(QtProperty*)));
 
         QtProperty *property = manager->createProperty(QtPropertyType::STRING);
         property->setName("name");
@@ -207,11 +207,13 @@ void MainWindow::createProperties()
         root->addChild(prop);
     }
 
-    connect(root, SIGNAL(signalValueChange(QtProperty*)), this, SLOT(onValueChanged(QtProperty*)));
+    connect(root->getNotifier(), SIGNAL(signalValueChange(QtProperty*)), this, SLOT(onValueChanged(QtProperty*)));
 }
 
 MainWindow::~MainWindow()
 {
+    // properties are not owned by the factory, delete the tree while the browsers are alive.
+    root_->destroy();
     delete ui;
 }
 
@@ -228,7 +230,7 @@ void MainWindow::onValueChanged(QtProperty *property)
         QtProperty *geometry = root_->findChild("geometry");
         if(geometry != NULL)
         {
-            geometry->setVisible(property->getValue().toBool());
+            geometry->setVisible(property->getBoolValue());
         }
     }
 }
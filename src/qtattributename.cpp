@@ -1,4 +1,36 @@
 ﻿#include "qtattributename.h"
+#include "qtnametable_p.h"
+
+namespace
+{
+    QtNameTable createRegistry()
+    {
+        QtNameTable table;
+
+        // must match the order of QtAttributeName::BuiltinAtom.
+        table.add("size");
+        table.add("minValue");
+        table.add("maxValue");
+        table.add("enumNames");
+        table.add("enumValues");
+        table.add("flagNames");
+        table.add("decimals");
+        table.add("readOnly");
+        table.add("fileDialogType");
+        table.add("fileDialogFilter");
+        table.add("fileRelativePath");
+        table.add("valueType");
+        table.add("valueDefault");
+        table.add("valueAttributes");
+        return table;
+    }
+
+    QtNameTable& registry()
+    {
+        static QtNameTable table = createRegistry();
+        return table;
+    }
+}
 
 namespace QtAttributeName
 {
@@ -13,4 +45,22 @@ namespace QtAttributeName
     const QString FileDialogType = "fileDialogType";
     const QString FileDialogFilter = "fileDialogFilter";
     const QString FileRelativePath = "fileRelativePath";
+    const QString ValueType = "valueType";
+    const QString ValueDefault = "valueDefault";
+    const QString ValueAttributes = "valueAttributes";
+
+    Atom registerAtom(const QString &name)
+    {
+        return registry().add(name);
+    }
+
+    Atom findAtom(const QString &name)
+    {
+        return registry().find(name, -1);
+    }
+
+    QString atomName(Atom atom)
+    {
+        return registry().name(atom);
+    }
 }
@@ -17,6 +17,43 @@ namespace QtAttributeName
     QTPROPERTYSHEET_DLL extern const QString FileDialogType;
     QTPROPERTYSHEET_DLL extern const QString FileDialogFilter;
     QTPROPERTYSHEET_DLL extern const QString FileRelativePath;
+    QTPROPERTYSHEET_DLL extern const QString ValueType;
+    QTPROPERTYSHEET_DLL extern const QString ValueDefault;
+    QTPROPERTYSHEET_DLL extern const QString ValueAttributes;
+
+    /** 属性名称的原子。每个名称对应一个很小的整数，比较和查找都不再需要字符串运算。
+     *  内置名称的原子是编译期常量；其它名称通过registerAtom注册得到原子。
+     */
+    typedef int Atom;
+
+    enum BuiltinAtom
+    {
+        SIZE,
+        MIN_VALUE,
+        MAX_VALUE,
+        ENUM_NAME,
+        ENUM_VALUES,
+        FLAG_NAME,
+        DECIMALS,
+        READ_ONLY,
+        FILE_DIALOG_TYPE,
+        FILE_DIALOG_FILTER,
+        FILE_RELATIVE_PATH,
+        VALUE_TYPE,
+        VALUE_DEFAULT,
+        VALUE_ATTRIBUTES,
+
+        NUM_BUILTIN_ATOMS
+    };
+
+    /** 注册属性名称，返回它的原子。重复注册同一个名称返回相同的原子。*/
+    QTPROPERTYSHEET_DLL Atom registerAtom(const QString &name);
+
+    /** 查找属性名称的原子，未注册的名称返回-1。*/
+    QTPROPERTYSHEET_DLL Atom findAtom(const QString &name);
+
+    /** 返回原子对应的名称。无效的原子返回空字符串。*/
+    QTPROPERTYSHEET_DLL QString atomName(Atom atom);
 }
 
 #endif // QTATTRIBUTENAME_H
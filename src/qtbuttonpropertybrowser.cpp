@@ -77,6 +77,8 @@ void QtButtonPropertyBrowser::addProperty(QtProperty *property)
         return;
     }
 
+    // changes of all properties arrive through the factory, no connection per property.
+    listenTo(property);
     addProperty(property, rootItem_);
 }
 
@@ -85,19 +87,26 @@ void QtButtonPropertyBrowser::addProperty(QtProperty *property, QtButtonProperty
     assert(parentItem != NULL);
 
     QtButtonPropertyItem *item = NULL;
-    if(property->isSelfVisible())
+    if(!property->isSelfVisible())
+    {
+        // a hidden property can not be expanded, its children are shown right away.
+        property->populate();
+    }
+    else
     {
         item = new QtButtonPropertyItem(property, parentItem, editorFactory_);
         parentItem->addChild(item);
         parentItem = item;
+
+        // lazy children are created when the item is expanded.
+        if(property->getChildProvider() != NULL)
+        {
+            item->setExpanded(property->isPopulated());
+            connect(item, SIGNAL(signalExpandChanged(QtButtonPropertyItem*,bool)), this, SLOT(slotItemExpandChanged(QtButtonPropertyItem*,bool)));
+        }
     }
     property2items_[property] = item;
 
-    connect(property, SIGNAL(signalPropertyInserted(QtProperty*,QtProperty*)), this, SLOT(slotPropertyInsert(QtProperty*,QtProperty*)));
-    connect(property, SIGNAL(signalPropertyRemoved(QtProperty*,QtProperty*)), this, SLOT(slotPropertyRemove(QtProperty*,QtProperty*)));
-    connect(property, SIGNAL(signalValueChange(QtProperty*)), this, SLOT(slotPropertyValueChange(QtProperty*)));
-    connect(property, SIGNAL(signalPropertyChange(QtProperty*)), this, SLOT(slotPropertyPropertyChange(QtProperty*)));
-
     // add it's children finaly.
     foreach(QtProperty *child, property->getChildren())
     {
@@ -117,17 +126,30 @@ void QtButtonPropertyBrowser::removeProperty(QtProperty *property)
         }
 
         property2items_.erase(it);
-        disconnect(property, 0, this, 0);
 
         // remove it's children first.
-        foreach(QtProperty *child, property->getChildren())
+        removeChildren(property, item == NULL);
+
+        // then remove this QtButtonPropertyItem, together with the items below it.
+        if(item != NULL)
         {
-            removeProperty(child);
+            deleteItem(item);
         }
+    }
+}
 
-        // then remove this QtButtonPropertyItem
-        if(item != NULL)
+void QtButtonPropertyBrowser::removeChildren(QtProperty *property, bool deleteItems)
+{
+    foreach(QtProperty *child, property->getChildren())
+    {
+        QtButtonPropertyItem *item = property2items_.take(child);
+
+        // an item deletes its children, only the items under a hidden
+        // property have to be deleted one by one.
+        removeChildren(child, deleteItems && item == NULL);
+        if(deleteItems && item != NULL)
         {
+            item->removeFromParent();
             deleteItem(item);
         }
     }
@@ -143,10 +165,47 @@ void QtButtonPropertyBrowser::removeAllProperties()
     property2items_.clear();
 }
 
+void QtButtonPropertyBrowser::onPropertyInsert(QtProperty *property, QtProperty *parent)
+{
+    // the factory reports every property, only follow the ones shown here.
+    if(property2items_.contains(parent))
+    {
+        slotPropertyInsert(property, parent);
+
+        // new items are appended, move it to its place when inserted in the middle.
+        if(parent->indexChild(property) + 1 < parent->getChildren().size())
+        {
+            reorderChildren(parent);
+        }
+    }
+}
+
+void QtButtonPropertyBrowser::onPropertyRemove(QtProperty *property, QtProperty *parent)
+{
+    slotPropertyRemove(property, parent);
+}
+
+void QtButtonPropertyBrowser::onPropertyValueChange(QtProperty *property)
+{
+    slotPropertyValueChange(property);
+}
+
+void QtButtonPropertyBrowser::onPropertyPropertyChange(QtProperty *property)
+{
+    slotPropertyPropertyChange(property);
+}
+
+void QtButtonPropertyBrowser::onPropertyReorder(QtProperty *parent)
+{
+    if(property2items_.contains(parent))
+    {
+        reorderChildren(parent);
+    }
+}
+
 void QtButtonPropertyBrowser::slotPropertyInsert(QtProperty *property, QtProperty *parent)
 {
-    QtButtonPropertyItem *parentItem = property2items_.value(parent);
-    addProperty(property, parentItem);
+    addProperty(property, containerItem(parent));
 }
 
 void QtButtonPropertyBrowser::slotPropertyRemove(QtProperty *property, QtProperty * /*parent*/)
@@ -156,12 +215,11 @@ void QtButtonPropertyBrowser::slotPropertyRemove(QtProperty *property, QtPropert
 
 void QtButtonPropertyBrowser::slotPropertyValueChange(QtProperty *property)
 {
-//    QtButtonPropertyItem *item = property2items_.value(property);
-//    if(item != NULL)
-//    {
-//        item->setText(1, property->getValueString());
-//        item->setIcon(1, property->getValueIcon());
-//    }
+    QtButtonPropertyItem *item = property2items_.value(property);
+    if(item != NULL)
+    {
+        item->onPropertyValueChange(property);
+    }
 }
 
 void QtButtonPropertyBrowser::slotPropertyPropertyChange(QtProperty *property)
@@ -174,11 +232,65 @@ void QtButtonPropertyBrowser::slotPropertyPropertyChange(QtProperty *property)
     }
 }
 
+QtButtonPropertyItem* QtButtonPropertyBrowser::containerItem(QtProperty *property)
+{
+    while(property != NULL && property2items_.contains(property))
+    {
+        QtButtonPropertyItem *item = property2items_.value(property);
+        if(item != NULL)
+        {
+            return item;
+        }
+        property = property->getParent();
+    }
+    return rootItem_;
+}
+
+void QtButtonPropertyBrowser::collectChildItems(QtProperty *property, QList<QtButtonPropertyItem*> &items)
+{
+    foreach(QtProperty *child, property->getChildren())
+    {
+        Property2ItemMap::iterator it = property2items_.find(child);
+        if(it == property2items_.end())
+        {
+            continue;
+        }
+
+        if(it.value() != NULL)
+        {
+            items.push_back(it.value());
+        }
+        else
+        {
+            collectChildItems(child, items);
+        }
+    }
+}
+
+void QtButtonPropertyBrowser::reorderChildren(QtProperty *parent)
+{
+    QList<QtButtonPropertyItem*> items;
+    collectChildItems(parent, items);
+    containerItem(parent)->reorderChildren(items);
+}
+
 void QtButtonPropertyBrowser::slotViewDestroy(QObject *p)
 {
     removeAllProperties();
 }
 
+void QtButtonPropertyBrowser::slotItemExpandChanged(QtButtonPropertyItem *item, bool expand)
+{
+    if(expand)
+    {
+        lazyExpanded(item->property());
+    }
+    else
+    {
+        lazyCollapsed(item->property());
+    }
+}
+
 void QtButtonPropertyBrowser::deleteItem(QtButtonPropertyItem *item)
 {
     delete item;
@@ -35,6 +35,12 @@ public:
     virtual bool isExpanded(QtProperty *property);
     virtual void setExpanded(QtProperty *property, bool expand);
 
+    virtual void onPropertyInsert(QtProperty *property, QtProperty *parent);
+    virtual void onPropertyRemove(QtProperty *property, QtProperty *parent);
+    virtual void onPropertyValueChange(QtProperty *property);
+    virtual void onPropertyPropertyChange(QtProperty *property);
+    virtual void onPropertyReorder(QtProperty *parent);
+
 public slots:
     void slotPropertyInsert(QtProperty *property, QtProperty *parent);
     void slotPropertyRemove(QtProperty *property, QtProperty *parent);
@@ -42,10 +48,17 @@ public slots:
     void slotPropertyPropertyChange(QtProperty *property);
 
     void slotViewDestroy(QObject *p);
+    void slotItemExpandChanged(QtButtonPropertyItem *item, bool expand);
 
 private:
     void addProperty(QtProperty *property, QtButtonPropertyItem *parentItem);
     void deleteItem(QtButtonPropertyItem *item);
+    void removeChildren(QtProperty *property, bool deleteItems);
+
+    /** 子属性的条目所在的QtButtonPropertyItem。隐藏属性的子属性放在最近的可见祖先下。*/
+    QtButtonPropertyItem* containerItem(QtProperty *property);
+    void collectChildItems(QtProperty *property, QList<QtButtonPropertyItem*> &items);
+    void reorderChildren(QtProperty *parent);
 
     QtPropertyEditorFactory*    editorFactory_;
 
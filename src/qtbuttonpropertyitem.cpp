@@ -5,6 +5,9 @@
 #include <QGridLayout>
 #include <QLabel>
 #include <QToolButton>
+#include <QVector>
+#include <algorithm>
+#include <cassert>
 
 QtButtonPropertyItem::QtButtonPropertyItem()
     : property_(NULL)
@@ -35,7 +38,7 @@ QtButtonPropertyItem::QtButtonPropertyItem(QtProperty *prop, QtButtonPropertyIte
 {
     layout_ = parent->layout_;
 
-    if(!property_->getChildren().empty())
+    if(property_->hasChildren())
     {
         int row = layout_->rowCount();
 
@@ -103,11 +106,6 @@ QtButtonPropertyItem::QtButtonPropertyItem(QtProperty *prop, QtButtonPropertyIte
             layout_->addWidget(valueLabel_, row, 1, Qt::AlignLeft);
         }
     }
-
-    if(valueLabel_ != nullptr)
-    {
-        connect(property_, SIGNAL(signalValueChange(QtProperty*)), this, SLOT(onPropertyValueChange(QtProperty*)));
-    }
 }
 
 QtButtonPropertyItem::~QtButtonPropertyItem()
@@ -164,6 +162,115 @@ void QtButtonPropertyItem::removeFromParent()
     }
 }
 
+void QtButtonPropertyItem::reorderChildren(const QList<QtButtonPropertyItem*> &items)
+{
+    if(items.empty())
+    {
+        return;
+    }
+
+    // items that are not children of this item are skipped.
+    QVector<int> positions;
+    QVector<QtButtonPropertyItem*> placed;
+    positions.reserve(items.size());
+    placed.reserve(items.size());
+    foreach(QtButtonPropertyItem *item, items)
+    {
+        int position = children_.indexOf(item);
+        assert(position >= 0);
+        if(position >= 0)
+        {
+            positions.push_back(position);
+            placed.push_back(item);
+        }
+    }
+    std::sort(positions.begin(), positions.end());
+    for(int i = 0; i < placed.size(); ++i)
+    {
+        children_[positions[i]] = placed[i];
+    }
+
+    // groups take two rows and leaves one, so the rows are laid out again
+    // from the first child on.
+    int row = -1;
+    foreach(QtButtonPropertyItem *child, children_)
+    {
+        int first = child->firstRow();
+        if(first >= 0 && (row < 0 || first < row))
+        {
+            row = first;
+        }
+    }
+    if(row < 0)
+    {
+        return;
+    }
+
+    foreach(QtButtonPropertyItem *child, children_)
+    {
+        row = child->placeAt(row);
+    }
+}
+
+int QtButtonPropertyItem::firstRow() const
+{
+    QWidget *widget = titleButton_ != NULL ? (QWidget*)titleButton_ : (QWidget*)label_;
+    if(widget == NULL || parent_ == NULL)
+    {
+        return -1;
+    }
+
+    int index = parent_->layout_->indexOf(widget);
+    if(index < 0)
+    {
+        return -1;
+    }
+
+    int row, column, rowSpan, columnSpan;
+    parent_->layout_->getItemPosition(index, &row, &column, &rowSpan, &columnSpan);
+    return row;
+}
+
+int QtButtonPropertyItem::placeAt(int row)
+{
+    QGridLayout *layout = parent_->layout_;
+    if(titleButton_ != NULL)
+    {
+        layout->removeWidget(titleButton_);
+        layout->addWidget(titleButton_, row, 0);
+        if(titleMenu_ != NULL)
+        {
+            layout->removeWidget(titleMenu_);
+            layout->addWidget(titleMenu_, row, 1, Qt::AlignRight);
+        }
+        if(valueLabel_ != NULL)
+        {
+            layout->removeWidget(valueLabel_);
+            layout->addWidget(valueLabel_, row, 1, Qt::AlignLeft);
+        }
+        layout->removeWidget(container_);
+        layout->addWidget(container_, row + 1, 0, 1, 2);
+        return row + 2;
+    }
+    else if(label_ != NULL)
+    {
+        layout->removeWidget(label_);
+        layout->addWidget(label_, row, 0);
+        if(editor_ != NULL)
+        {
+            layout->removeWidget(editor_);
+            layout->addWidget(editor_, row, 1);
+        }
+        if(valueLabel_ != NULL)
+        {
+            layout->removeWidget(valueLabel_);
+            layout->addWidget(valueLabel_, row, 1, Qt::AlignLeft);
+        }
+        return row + 1;
+    }
+    return row;
+}
+
 void QtButtonPropertyItem::setTitle(const QString &title)
 {
     if(titleButton_)
@@ -221,6 +328,7 @@ void QtButtonPropertyItem::setExpanded(bool expand)
     {
         container_->setVisible(expand);
     }
+    emit signalExpandChanged(this, expand);
 }
 
 void QtButtonPropertyItem::onBtnExpand()
@@ -230,11 +338,17 @@ void QtButtonPropertyItem::onBtnExpand()
 
 void QtButtonPropertyItem::onBtnMenu()
 {
-    emit property_->signalPopupMenu(property_);
+    emit property_->getNotifier()->signalPopupMenu(property_);
 }
 
-void QtButtonPropertyItem::onPropertyValueChange(QtProperty *property)
+void QtButtonPropertyItem::onPropertyValueChange(QtProperty * /*property*/)
 {
+    // properties with an editor update it themselves.
+    if(valueLabel_ == nullptr)
+    {
+        return;
+    }
+
     QString text = property_->getValueString();
     if(text.size() > 20)
     {
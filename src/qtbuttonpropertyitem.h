@@ -26,6 +26,10 @@ public:
     void addChild(QtButtonPropertyItem *child);
     void removeChild(QtButtonPropertyItem *child);
     void removeFromParent();
+    const QList<QtButtonPropertyItem*>& getChildren() const { return children_; }
+
+    /** 按新的顺序排列子条目。items是其中一部分子条目，依次填回它们原来占据的位置。*/
+    void reorderChildren(const QList<QtButtonPropertyItem*> &items);
 
     void setTitle(const QString &title);
     void setVisible(bool visible);
@@ -38,12 +42,22 @@ public:
     void setExpanded(bool expand);
     bool isExpanded() const{ return bExpand_; }
 
+    /** 属性的值变化，由browser转发。*/
+    void onPropertyValueChange(QtProperty *property);
+
+signals:
+    void signalExpandChanged(QtButtonPropertyItem *item, bool expand);
+
 protected slots:
     void onBtnExpand();
     void onBtnMenu();
-    void onPropertyValueChange(QtProperty *property);
 
 protected:
+    /** 条目在父布局中的首行，-1表示没有控件。*/
+    int firstRow() const;
+    /** 把控件移到父布局的row行，返回下一个空闲行。*/
+    int placeAt(int row);
+
     QtProperty* property_;
     QLabel*     label_;
     QWidget*    editor_; // can be null
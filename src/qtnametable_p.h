@@ -0,0 +1,50 @@
+#ifndef QTNAMETABLE_P_H
+#define QTNAMETABLE_P_H
+
+#include <QHash>
+#include <QVector>
+#include <QString>
+
+// Interns strings into dense integer ids. Used by the property type and
+// attribute name registries; not part of the public API.
+class QtNameTable
+{
+public:
+    int add(const QString &name)
+    {
+        QHash<QString, int>::const_iterator it = ids_.constFind(name);
+        if(it != ids_.constEnd())
+        {
+            return *it;
+        }
+
+        int id = names_.size();
+        names_.push_back(name);
+        ids_.insert(name, id);
+        return id;
+    }
+
+    int find(const QString &name, int defaultId) const
+    {
+        return ids_.value(name, defaultId);
+    }
+
+    // returned by value: names_ relocates its strings when it grows, so a
+    // reference would dangle after the next add().
+    QString name(int id) const
+    {
+        if(id >= 0 && id < names_.size())
+        {
+            return names_[id];
+        }
+        return QString();
+    }
+
+    int size() const { return names_.size(); }
+
+private:
+    QVector<QString>    names_;
+    QHash<QString, int> ids_;
+};
+
+#endif // QTNAMETABLE_P_H
@@ -3,177 +3,1322 @@
 #include "qtpropertybrowserutils.h"
 #include "qtattributename.h"
 #include "qtpropertytype.h"
+#include "qtpropertyarena.h"
 
 #include <QLocale>
+#include <QCoreApplication>
 #include <cassert>
 #include <algorithm>
+#include <limits>
+
+/** 按属性索引的推迟信号列表，删除属性时不必扫描整个列表。*/
+template<typename Entry>
+class QtPendingList
+{
+public:
+    typedef QVector<Entry> Entries;
+
+    const Entries& entries() const { return entries_; }
+    bool isEmpty() const { return entries_.isEmpty(); }
+    int size() const { return entries_.size(); }
+    const Entry& at(int i) const { return entries_.at(i); }
+
+    void push(const Entry &entry)
+    {
+        index_.insert(entryProperty(entry), entries_.size());
+        entries_.push_back(entry);
+    }
+
+    /** property在列表中的位置。*/
+    QList<int> positions(QtProperty *property) const { return index_.values(property); }
+
+    /** 把property的所有条目置为NULL。*/
+    void forget(QtProperty *property)
+    {
+        QMultiHash<QtProperty*, int>::iterator it = index_.find(property);
+        while(it != index_.end() && it.key() == property)
+        {
+            clearEntry(entries_[it.value()]);
+            it = index_.erase(it);
+        }
+    }
+
+    void clear()
+    {
+        entries_.clear();
+        index_.clear();
+    }
+
+    void swap(QtPendingList &other)
+    {
+        entries_.swap(other.entries_);
+        index_.swap(other.index_);
+    }
+
+private:
+    static QtProperty* entryProperty(QtProperty *property){ return property; }
+    static QtProperty* entryProperty(const QPair<QtProperty*, int> &entry){ return entry.first; }
+    static void clearEntry(QtProperty *&property){ property = NULL; }
+    static void clearEntry(QPair<QtProperty*, int> &entry){ entry.first = NULL; }
+
+    Entries                         entries_;
+    QMultiHash<QtProperty*, int>    index_;
+};
+
+/** 批量更新期间推迟的信号。*/
+class QtPropertyUpdateBatch
+{
+public:
+    enum PendingFlag
+    {
+        PENDING_VALUE = 1,
+        PENDING_PROPERTY = 2,
+        PENDING_ATTRIBUTE = 4,
+    };
+    typedef QPair<QtProperty*, int> AttributeEntry;
+
+    explicit QtPropertyUpdateBatch(QtProperty *owner)
+        : owner_(owner)
+        , depth_(0)
+        , flushing_(false)
+    {}
+
+    void addPending(QtProperty *property, int flag);
+    void addAttribute(QtProperty *property, int atom);
+
+    /** 把未发出的信号转交给外层的批量更新。*/
+    void moveTo(QtPropertyUpdateBatch *outer);
+
+    /** 发出所有推迟的信号。信号处理中产生的新信号会在同一次flush中发出。*/
+    void flush();
+
+    /** 属性被删除时，移除对它的引用。*/
+    void forget(QtProperty *property);
+
+    QtProperty*                     owner_;
+    int                             depth_;
+    bool                            flushing_;
+    QtPendingList<QtProperty*>      pending_;
+    QtPendingList<QtProperty*>      flushingProperties_;
+    QtPendingList<AttributeEntry>   attributes_;
+    QtPendingList<AttributeEntry>   flushingAttributes_;
+};
+
+// batches currently open, usually none or one.
+static QVector<QtPropertyUpdateBatch*> activeBatches;
+
+void QtPropertyUpdateBatch::addPending(QtProperty *property, int flag)
+{
+    if((property->pending_ & (PENDING_VALUE | PENDING_PROPERTY)) == 0)
+    {
+        pending_.push(property);
+    }
+    property->pending_ |= flag;
+}
+
+void QtPropertyUpdateBatch::addAttribute(QtProperty *property, int atom)
+{
+    if(property->pending_ & PENDING_ATTRIBUTE)
+    {
+        foreach(int i, attributes_.positions(property))
+        {
+            if(attributes_.at(i).second == atom)
+            {
+                return;
+            }
+        }
+    }
+    attributes_.push(AttributeEntry(property, atom));
+    property->pending_ |= PENDING_ATTRIBUTE;
+}
+
+void QtPropertyUpdateBatch::moveTo(QtPropertyUpdateBatch *outer)
+{
+    foreach(QtProperty *property, pending_.entries())
+    {
+        if(property != NULL)
+        {
+            int flags = property->pending_ & (PENDING_VALUE | PENDING_PROPERTY);
+            property->pending_ &= ~flags;
+            outer->addPending(property, flags);
+        }
+    }
+    pending_.clear();
+
+    foreach(const AttributeEntry &entry, attributes_.entries())
+    {
+        if(entry.first != NULL)
+        {
+            outer->addAttribute(entry.first, entry.second);
+        }
+    }
+    attributes_.clear();
+}
+
+void QtPropertyUpdateBatch::flush()
+{
+    flushing_ = true;
+    while(!pending_.isEmpty() || !attributes_.isEmpty())
+    {
+        flushingAttributes_.swap(attributes_);
+        foreach(const AttributeEntry &entry, flushingAttributes_.entries())
+        {
+            if(entry.first != NULL)
+            {
+                entry.first->pending_ &= ~PENDING_ATTRIBUTE;
+            }
+        }
+        for(int i = 0; i < flushingAttributes_.size(); ++i)
+        {
+            // an earlier handler may have deleted the property.
+            AttributeEntry entry = flushingAttributes_.at(i);
+            if(entry.first != NULL)
+            {
+                entry.first->emitAttributeChange(entry.second);
+            }
+        }
+        flushingAttributes_.clear();
+
+        flushingProperties_.swap(pending_);
+        for(int i = 0; i < flushingProperties_.size(); ++i)
+        {
+            QtProperty *property = flushingProperties_.at(i);
+            if(property == NULL)
+            {
+                continue;
+            }
+
+            int flags = property->pending_;
+            property->pending_ &= ~(PENDING_VALUE | PENDING_PROPERTY);
+            if(flags & PENDING_PROPERTY)
+            {
+                property->emitPropertyChange();
+            }
+            if((flags & PENDING_VALUE) && flushingProperties_.at(i) != NULL)
+            {
+                property->emitValueChange();
+            }
+        }
+        flushingProperties_.clear();
+    }
+    flushing_ = false;
+}
+
+void QtPropertyUpdateBatch::forget(QtProperty *property)
+{
+    pending_.forget(property);
+    flushingProperties_.forget(property);
+    attributes_.forget(property);
+    flushingAttributes_.forget(property);
+}
+
+/********************************************************************/
+
+namespace
+{
+// staleFrom_ when every position is up to date.
+const int NoStaleIndex = std::numeric_limits<int>::max();
+
+// every property is preceded by the arena it came from, NULL for the heap.
+// the size keeps the object aligned as ::operator new would.
+const size_t AllocHeaderSize = 16;
+}
+
+void* QtProperty::operator new(size_t size)
+{
+    return QtProperty::operator new(size, static_cast<QtPropertyArena*>(NULL));
+}
+
+void* QtProperty::operator new(size_t size, QtPropertyArena *arena)
+{
+    size += AllocHeaderSize;
+    char *block = static_cast<char*>(arena != NULL ? arena->allocate(size) : ::operator new(size));
+    *reinterpret_cast<QtPropertyArena**>(block) = arena;
+    return block + AllocHeaderSize;
+}
+
+void QtProperty::operator delete(void *p)
+{
+    if(p == NULL)
+    {
+        return;
+    }
+
+    char *block = static_cast<char*>(p) - AllocHeaderSize;
+    QtPropertyArena *arena = *reinterpret_cast<QtPropertyArena**>(block);
+    if(arena != NULL)
+    {
+        arena->release(block);
+    }
+    else
+    {
+        ::operator delete(block);
+    }
+}
+
+void QtProperty::operator delete(void *p, QtPropertyArena* /*arena*/)
+{
+    QtProperty::operator delete(p);
+}
 
 QtProperty::QtProperty(Type type, QtPropertyFactory *factory)
-    : QObject(factory)
-    , factory_(factory)
+    : factory_(factory)
     , type_(type)
+    , valueKind_(QtPropertyValue::kindOfType(type))
+    , variantDirty_(false)
     , parent_(NULL)
+    , index_(-1)
+    , staleFrom_(NoStaleIndex)
+    , staleShift_(0)
     , visible_(true)
     , selfVisible_(true)
     , menuVisible_(false)
+    , modified_(false)
+    , mixed_(false)
+    , modifiedCount_(0)
+    , provider_(NULL)
+    , populated_(false)
+    , notifier_(NULL)
+    , destroying_(false)
+    , batch_(NULL)
+    , pending_(0)
+    , weakRef_(NULL)
 {
 
 }
 
 QtProperty::~QtProperty()
 {
-    emit signalPropertyRemoved(this, parent_);
+    if(notifier_ != NULL)
+    {
+        emit notifier_->signalDestroyed(this);
+    }
+    if(weakRef_ != NULL)
+    {
+        weakRef_->property = NULL;
+        if(--weakRef_->refCount == 0)
+        {
+            delete weakRef_;
+        }
+    }
+
+    if(!destroying_)
+    {
+        if(notifier_ != NULL)
+        {
+            emit notifier_->signalPropertyRemoved(this, parent_);
+        }
+        if(factory_ != NULL)
+        {
+            factory_->dispatchPropertyRemove(this, parent_);
+        }
+    }
+
+    // each forget is a hash lookup, the loop only runs over the open batches.
+    foreach(QtPropertyUpdateBatch *batch, activeBatches)
+    {
+        if(pending_ != 0 || batch->flushing_)
+        {
+            batch->forget(this);
+        }
+    }
+
+    if(destroying_)
+    {
+        // the listeners have dropped the whole subtree already, delete it silently.
+        foreach(QtProperty *child, children_)
+        {
+            child->parent_ = NULL;
+            child->index_ = -1;
+            child->destroying_ = true;
+            delete child;
+        }
+        children_.clear();
+    }
+    else
+    {
+        removeAllChildren(true);
+    }
+
+    if(batch_ != NULL)
+    {
+        QtPropertyUpdateBatch *batch = batch_;
+        batch_ = NULL;
+        batch->owner_ = NULL;
+
+        // a flushing batch is released by the endUpdate running the flush.
+        if(!batch->flushing_)
+        {
+            // the subtree is gone, deliver what is left to properties moved out of it.
+            QtPropertyUpdateBatch *outer = parent_ != NULL ? parent_->findBatch() : NULL;
+            if(outer != NULL)
+            {
+                batch->moveTo(outer);
+            }
+            else
+            {
+                batch->flush();
+            }
+            activeBatches.removeOne(batch);
+            delete batch;
+        }
+    }
 
-    removeAllChildren(true);
     removeFromParent();
+
+    // a hidden child is still linked to its parent.
+    if(parent_ != NULL && modifiedCount_ != 0)
+    {
+        parent_->addModified(-modifiedCount_);
+    }
+
+    delete notifier_;
+}
+
+QtPropertyNotifier* QtProperty::getNotifier()
+{
+    if(notifier_ == NULL)
+    {
+        notifier_ = new QtPropertyNotifier(this);
+    }
+    return notifier_;
+}
+
+QtPropertyWeakRef* QtProperty::getWeakRef()
+{
+    if(weakRef_ == NULL)
+    {
+        weakRef_ = new QtPropertyWeakRef;
+        weakRef_->property = this;
+        weakRef_->refCount = 1;
+    }
+    return weakRef_;
 }
 
 void QtProperty::setName(const QString &name)
 {
-    if(name != name_)
+    if(name != definition_.getName())
     {
-        name_ = name;
-        emit signalPropertyChange(this);
+        QString oldName = definition_.getName();
+        definition_.setName(name);
+        if(parent_ != NULL)
+        {
+            parent_->renameIndex(this, oldName, name);
+        }
+        notifyPropertyChange();
     }
 }
 
 const QString& QtProperty::getTitle() const
 {
-    return title_.isEmpty() ? name_ : title_;
+    const QString &title = definition_.getTitle();
+    return title.isEmpty() ? definition_.getName() : title;
 }
 
 void QtProperty::setTitle(const QString &title)
 {
-    if(title != title_)
+    if(title != definition_.getTitle())
     {
-        title_ = title;
-        emit signalPropertyChange(this);
+        definition_.setTitle(title);
+        notifyPropertyChange();
     }
 }
 
-void QtProperty::setValue(const QVariant &value)
+void QtProperty::setDefinition(const QtPropertyDefinition &definition)
 {
-    if(value_ != value)
+    if(!definition_.isSharedWith(definition))
     {
-        value_ = value;
-        emit signalValueChange(this);
+        QString oldName = definition_.getName();
+        QtPropertyAttributes oldAttributes = definition_.getAttributes();
+        definition_ = definition;
+        if(parent_ != NULL && oldName != definition_.getName())
+        {
+            parent_->renameIndex(this, oldName, definition_.getName());
+        }
+        cacheDefaultValue();
+        onDefinitionChange();
+        updateModified();
+        notifyPropertyChange();
+        notifyAttributeDifference(oldAttributes, definition_.getAttributes());
     }
 }
 
-void QtProperty::setVisible(bool visible)
+void QtProperty::notifyAttributeDifference(const QtPropertyAttributes &oldAttributes,
+                                           const QtPropertyAttributes &newAttributes)
 {
-    if(visible != visible_)
+    // both arrays are sorted by atom, one merge pass finds the changed atoms.
+    QtPropertyAttributes::const_iterator a = oldAttributes.begin();
+    QtPropertyAttributes::const_iterator b = newAttributes.begin();
+    while(a != oldAttributes.end() || b != newAttributes.end())
     {
-        visible_ = visible;
-        emit signalPropertyChange(this);
+        if(b == newAttributes.end() || (a != oldAttributes.end() && a->atom < b->atom))
+        {
+            notifyAttributeChange(a->atom);
+            ++a;
+        }
+        else if(a == oldAttributes.end() || b->atom < a->atom)
+        {
+            notifyAttributeChange(b->atom);
+            ++b;
+        }
+        else
+        {
+            if(a->value != b->value)
+            {
+                notifyAttributeChange(a->atom);
+            }
+            ++a;
+            ++b;
+        }
     }
 }
 
-QString QtProperty::getValueString() const
+void QtProperty::setDefaultValue(const QVariant &value)
 {
-    return value_.toString();
+    definition_.setDefaultValue(value);
+    cacheDefaultValue();
+    onDefaultValueChange();
+    updateModified();
 }
 
-QIcon QtProperty::getValueIcon() const
+bool QtProperty::isDefaultValue() const
 {
-    return QIcon();
+    if(valueKind_ != QtPropertyValue::VARIANT)
+    {
+        return scalar_ == defaultScalar_;
+    }
+    return value_ == definition_.getDefaultValue();
 }
 
-void QtProperty::setAttribute(const QString &name, const QVariant &value)
+void QtProperty::cacheDefaultValue()
 {
-    attributes_[name] = value;
+    if(valueKind_ != QtPropertyValue::VARIANT)
+    {
+        defaultScalar_ = QtPropertyValue::fromVariant(definition_.getDefaultValue(), valueKind_);
+    }
+}
 
-    emit signalAttributeChange(this, name);
+void QtProperty::updateModified()
+{
+    bool modified = definition_.getDefaultValue().isValid() && !isDefaultValue();
+    if(modified != modified_)
+    {
+        modified_ = modified;
+        addModified(modified ? 1 : -1);
+    }
 }
 
-QVariant QtProperty::getAttribute(const QString &name) const
+void QtProperty::addModified(int delta, bool notify)
+{
+    if(delta == 0)
+    {
+        return;
+    }
+
+    for(QtProperty *property = this; property != NULL; property = property->parent_)
+    {
+        bool wasModified = property->modifiedCount_ > 0;
+        property->modifiedCount_ += delta;
+        if(notify && wasModified != (property->modifiedCount_ > 0))
+        {
+            property->notifyPropertyChange();
+        }
+    }
+}
+
+void QtProperty::resetToDefault()
 {
-    QtPropertyAttributes::const_iterator it = attributes_.constFind(name);
-    if(it != attributes_.constEnd())
+    if(modifiedCount_ > 0)
     {
-        return *it;
+        QtPropertyUpdateGuard guard(this);
+        resetModified();
     }
-    return QVariant();
 }
 
-void QtProperty::addChild(QtProperty *child)
+void QtProperty::resetModified()
 {
-    assert(child->getParent() == NULL);
-    children_.push_back(child);
-    child->parent_ = this;
+    if(modified_)
+    {
+        setValue(definition_.getDefaultValue());
+    }
 
-    onChildAdd(child);
-    emit signalPropertyInserted(child, this);
+    // untouched branches are skipped, the cost follows the number of modified properties.
+    for(int i = 0; i < children_.size() && modifiedCount_ > 0; ++i)
+    {
+        if(children_[i]->modifiedCount_ > 0)
+        {
+            children_[i]->resetModified();
+        }
+    }
 }
 
-void QtProperty::removeChild(QtProperty *child)
+void QtProperty::setValue(const QVariant &value)
 {
-    assert(child->getParent() == this);
-    QtPropertyList::iterator it = std::find(children_.begin(), children_.end(), child);
-    if(it != children_.end())
+    if(valueKind_ != QtPropertyValue::VARIANT)
     {
-        child->parent_ = NULL;
-        children_.erase(it);
+        assignScalar(QtPropertyValue::fromVariant(value, valueKind_));
+    }
+    else if(value_ != value)
+    {
+        value_ = value;
+        notifyValueChange();
+    }
+}
 
-        onChildRemove(child);
-        emit signalPropertyRemoved(child, this);
+const QVariant& QtProperty::getValue() const
+{
+    // scalar values are converted only when someone asks for the QVariant.
+    if(variantDirty_)
+    {
+        QtProperty *self = const_cast<QtProperty*>(this);
+        self->value_ = scalar_.toVariant();
+        self->variantDirty_ = false;
     }
+    return value_;
 }
 
-void QtProperty::removeFromParent()
+void QtProperty::setScalarValue(const QtPropertyValue &value)
 {
-    if(parent_ != NULL)
+    if(valueKind_ == QtPropertyValue::VARIANT)
     {
-        parent_->removeChild(this);
+        setValue(value.toVariant());
+    }
+    else if(value.getKind() == valueKind_ || value.isNull())
+    {
+        assignScalar(value);
+    }
+    else
+    {
+        assignScalar(value.convert(valueKind_));
     }
 }
 
-void QtProperty::removeAllChildren(bool clean)
+QtPropertyValue QtProperty::getScalarValue() const
 {
-    QtPropertyList temp = children_;
-    foreach(QtProperty *child, temp)
+    if(valueKind_ != QtPropertyValue::VARIANT)
     {
-        removeChild(child);
+        return scalar_;
+    }
+    return QtPropertyValue::fromVariant(getValue(), QtPropertyValue::VARIANT);
+}
 
-        if(clean)
-        {
-            delete child;
-        }
+void QtProperty::assignScalar(const QtPropertyValue &value)
+{
+    if(scalar_ != value)
+    {
+        scalar_ = value;
+        variantDirty_ = true;
+        notifyValueChange();
     }
 }
 
-int QtProperty::indexChild(const QtProperty *child) const
+void QtProperty::setVisible(bool visible)
+{
+    if(visible != visible_)
+    {
+        visible_ = visible;
+        notifyPropertyChange();
+    }
+}
+
+void QtProperty::setMixed(bool mixed)
+{
+    if(mixed != mixed_)
+    {
+        mixed_ = mixed;
+        notifyPropertyChange();
+    }
+}
+
+void QtProperty::setChildProvider(QtPropertyChildProvider *provider)
+{
+    if(provider != provider_)
+    {
+        provider_ = provider;
+        populated_ = !children_.isEmpty();
+        notifyPropertyChange();
+    }
+}
+
+void QtProperty::populate()
 {
-    return children_.indexOf(const_cast<QtProperty*>(child));
+    if(isPopulated())
+    {
+        return;
+    }
+
+    // set first, the provider may look the children up while adding them.
+    populated_ = true;
+    provider_->populateChildren(this);
+
+    // browsers drop the expand indicator when nothing was created.
+    notifyPropertyChange();
+}
+
+bool QtProperty::releaseChildren()
+{
+    if(provider_ == NULL || !populated_ || !provider_->canReleaseChildren(this))
+    {
+        return false;
+    }
+
+    // edited values below this node would be lost.
+    if(modifiedCount_ > (modified_ ? 1 : 0))
+    {
+        return false;
+    }
+    if(factory_ != NULL && factory_->isChildrenInUse(this))
+    {
+        return false;
+    }
+
+    populated_ = false;
+    while(!children_.isEmpty())
+    {
+        children_.back()->destroy();
+    }
+    provider_->onChildrenReleased(this);
+    notifyPropertyChange();
+    return true;
+}
+
+bool QtProperty::isInSubtreeOf(const QtProperty *ancestor) const
+{
+    for(const QtProperty *property = this; property != NULL; property = property->parent_)
+    {
+        if(property == ancestor)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+QString QtProperty::getValueString() const
+{
+    if(valueKind_ != QtPropertyValue::VARIANT)
+    {
+        return scalar_.toString();
+    }
+    return value_.toString();
+}
+
+QIcon QtProperty::getValueIcon() const
+{
+    return QIcon();
+}
+
+void QtProperty::setAttribute(QtAttributeName::Atom atom, const QVariant &value)
+{
+    definition_.setAttribute(atom, value);
+
+    notifyAttributeChange(atom);
+}
+
+void QtProperty::setAttribute(const QString &name, const QVariant &value)
+{
+    setAttribute(QtAttributeName::registerAtom(name), value);
+}
+
+QVariant QtProperty::getAttribute(const QString &name) const
+{
+    QtAttributeName::Atom atom = QtAttributeName::findAtom(name);
+    if(atom < 0)
+    {
+        return QVariant();
+    }
+    return definition_.getAttribute(atom);
+}
+
+void QtProperty::beginUpdate()
+{
+    if(batch_ == NULL)
+    {
+        batch_ = new QtPropertyUpdateBatch(this);
+        activeBatches.push_back(batch_);
+    }
+    ++batch_->depth_;
+}
+
+void QtProperty::endUpdate()
+{
+    assert(batch_ != NULL && batch_->depth_ > 0);
+    if(batch_ == NULL || --batch_->depth_ > 0 || batch_->flushing_)
+    {
+        return;
+    }
+
+    QtPropertyUpdateBatch *batch = batch_;
+    QtPropertyUpdateBatch *outer = parent_ != NULL ? parent_->findBatch() : NULL;
+    if(outer != NULL)
+    {
+        batch->moveTo(outer);
+    }
+    else
+    {
+        // handlers may delete this property, only the batch is used afterwards.
+        batch->flush();
+    }
+
+    if(batch->owner_ != NULL)
+    {
+        batch->owner_->batch_ = NULL;
+    }
+    activeBatches.removeOne(batch);
+    delete batch;
+}
+
+QtPropertyUpdateBatch* QtProperty::findBatch()
+{
+    if(activeBatches.isEmpty())
+    {
+        return NULL;
+    }
+
+    // the outermost batch collects the signals of the whole subtree.
+    QtPropertyUpdateBatch *batch = NULL;
+    for(QtProperty *property = this; property != NULL; property = property->parent_)
+    {
+        if(property->batch_ != NULL)
+        {
+            batch = property->batch_;
+        }
+    }
+    return batch;
+}
+
+void QtProperty::notifyValueChange()
+{
+    updateModified();
+
+    QtPropertyUpdateBatch *batch = findBatch();
+    if(batch != NULL)
+    {
+        batch->addPending(this, QtPropertyUpdateBatch::PENDING_VALUE);
+    }
+    else
+    {
+        emitValueChange();
+    }
+}
+
+void QtProperty::notifyPropertyChange()
+{
+    QtPropertyUpdateBatch *batch = findBatch();
+    if(batch != NULL)
+    {
+        batch->addPending(this, QtPropertyUpdateBatch::PENDING_PROPERTY);
+    }
+    else
+    {
+        emitPropertyChange();
+    }
+}
+
+void QtProperty::notifyAttributeChange(int atom)
+{
+    QtPropertyUpdateBatch *batch = findBatch();
+    if(batch != NULL)
+    {
+        batch->addAttribute(this, atom);
+    }
+    else
+    {
+        emitAttributeChange(atom);
+    }
+}
+
+void QtProperty::emitValueChange()
+{
+    // the parent collects the new value before anyone else sees it.
+    if(parent_ != NULL)
+    {
+        parent_->onChildValueChange(this);
+    }
+
+    if(notifier_ != NULL)
+    {
+        emit notifier_->signalValueChange(this);
+    }
+    if(factory_ != NULL)
+    {
+        factory_->dispatchValueChange(this);
+    }
+}
+
+void QtProperty::emitPropertyChange()
+{
+    if(notifier_ != NULL)
+    {
+        emit notifier_->signalPropertyChange(this);
+    }
+    if(factory_ != NULL)
+    {
+        factory_->dispatchPropertyChange(this);
+    }
+}
+
+void QtProperty::emitAttributeChange(int atom)
+{
+    if(notifier_ != NULL)
+    {
+        emit notifier_->signalAttributeChange(this, atom);
+    }
+    if(factory_ != NULL)
+    {
+        factory_->dispatchAttributeChange(this, atom);
+    }
+}
+
+void QtProperty::addChild(QtProperty *child)
+{
+    insertChild(children_.size(), child);
+}
+
+void QtProperty::insertChild(int index, QtProperty *child)
+{
+    assert(child->getParent() == NULL);
+    if(index < 0 || index > children_.size())
+    {
+        index = children_.size();
+    }
+
+    children_.insert(index, child);
+    renumberChildren(index);
+    child->parent_ = this;
+    insertIndex(indexEntries(child));
+    addModified(child->modifiedCount_);
+
+    onChildAdd(child);
+    if(notifier_ != NULL)
+    {
+        emit notifier_->signalPropertyInserted(child, this);
+    }
+    if(factory_ != NULL)
+    {
+        factory_->dispatchPropertyInsert(child, this);
+    }
+}
+
+void QtProperty::insertChildren(int index, const QtPropertyList &children)
+{
+    if(children.empty())
+    {
+        return;
+    }
+    if(index < 0 || index > children_.size())
+    {
+        index = children_.size();
+    }
+
+    children_.insert(index, children.size(), NULL);
+    for(int i = 0; i < children.size(); ++i)
+    {
+        QtProperty *child = children[i];
+        assert(child->getParent() == NULL);
+
+        children_[index + i] = child;
+        child->parent_ = this;
+        insertIndex(indexEntries(child));
+        addModified(child->modifiedCount_);
+    }
+    renumberChildren(index);
+    for(int i = 0; i < children.size(); ++i)
+    {
+        onChildAdd(children[i]);
+    }
+
+    int last = index + children.size() - 1;
+    if(notifier_ != NULL)
+    {
+        // connections made for single insertions keep working.
+        foreach(QtProperty *child, children)
+        {
+            emit notifier_->signalPropertyInserted(child, this);
+        }
+        emit notifier_->signalChildrenInserted(this, index, last);
+    }
+    if(factory_ != NULL)
+    {
+        factory_->dispatchChildrenInsert(this, index, last);
+    }
+}
+
+void QtProperty::removeChild(QtProperty *child)
+{
+    assert(child->getParent() == this);
+
+    // a hidden child has a parent but no position, it is ignored.
+    int index = indexChild(child);
+    if(index >= 0)
+    {
+        children_.remove(index);
+
+        // the later siblings are renumbered when they are looked up, see indexChild.
+        if(index < children_.size())
+        {
+            staleFrom_ = std::min(staleFrom_, index);
+            ++staleShift_;
+        }
+        child->parent_ = NULL;
+        child->index_ = -1;
+        removeIndex(indexEntries(child));
+        addModified(-child->modifiedCount_);
+
+        onChildRemove(child);
+        if(notifier_ != NULL)
+        {
+            emit notifier_->signalPropertyRemoved(child, this);
+        }
+        if(factory_ != NULL)
+        {
+            factory_->dispatchPropertyRemove(child, this);
+        }
+    }
+}
+
+int QtProperty::indexChild(const QtProperty *child) const
+{
+    int index = child->index_;
+    if(child->parent_ != this || index < 0)
+    {
+        return -1;
+    }
+    if(index < staleFrom_)
+    {
+        return index;
+    }
+
+    // only removals leave positions stale, so the child moved down by at most staleShift_.
+    int last = std::min(index, children_.size() - 1);
+    for(int i = std::max(staleFrom_, index - staleShift_); i <= last; ++i)
+    {
+        if(children_.at(i) == child)
+        {
+            child->index_ = i;
+            return i;
+        }
+    }
+    assert(false);
+    return -1;
+}
+
+void QtProperty::renumberChildren(int first)
+{
+    for(int i = std::min(first, staleFrom_); i < children_.size(); ++i)
+    {
+        children_[i]->index_ = i;
+    }
+    staleFrom_ = NoStaleIndex;
+    staleShift_ = 0;
+}
+
+void QtProperty::moveChild(int from, int to)
+{
+    if(from < 0 || from >= children_.size() || to < 0 || to >= children_.size() || from == to)
+    {
+        return;
+    }
+
+    children_.move(from, to);
+    childrenReordered(std::min(from, to), std::max(from, to));
+}
+
+void QtProperty::childrenReordered(int first, int last)
+{
+    for(int i = first; i <= last; ++i)
+    {
+        children_[i]->index_ = i;
+    }
+    if(first <= staleFrom_ && last + 1 >= children_.size())
+    {
+        staleFrom_ = NoStaleIndex;
+        staleShift_ = 0;
+    }
+
+    onChildrenReorder();
+    if(notifier_ != NULL)
+    {
+        emit notifier_->signalPropertyReordered(this);
+    }
+    if(factory_ != NULL)
+    {
+        factory_->dispatchPropertyReorder(this);
+    }
+}
+
+void QtProperty::removeFromParent()
+{
+    if(parent_ != NULL)
+    {
+        parent_->removeChild(this);
+    }
+}
+
+void QtProperty::removeAllChildren(bool clean)
+{
+    // remove from the back, so that no sibling has to be shifted.
+    while(!children_.isEmpty())
+    {
+        QtProperty *child = children_.back();
+        removeChild(child);
+
+        if(clean)
+        {
+            delete child;
+        }
+    }
+}
+
+QtProperty* QtProperty::clone() const
+{
+    QtProperty *copy = createProperty(type_);
+    copy->copyFrom(this);
+    return copy;
+}
+
+QtProperty* QtProperty::createProperty(Type type) const
+{
+    if(factory_ != NULL)
+    {
+        return factory_->createProperty(type);
+    }
+
+    // the factory is gone, plain properties still hold the values.
+    if(type == QtPropertyType::DYNAMIC_ITEM)
+    {
+        return new QtDynamicItemProperty(type, NULL);
+    }
+    return new QtProperty(type, NULL);
+}
+
+void QtProperty::copyFrom(const QtProperty *source)
+{
+    copyState(source);
+
+    children_.reserve(children_.size() + source->children_.size());
+    foreach(QtProperty *child, source->children_)
+    {
+        attachChild(child->clone());
+    }
+}
+
+void QtProperty::copyState(const QtProperty *source)
+{
+    // the definition is shared, not copied.
+    definition_ = source->definition_;
+    value_ = source->value_;
+    scalar_ = source->scalar_;
+    defaultScalar_ = source->defaultScalar_;
+    valueKind_ = source->valueKind_;
+    variantDirty_ = source->variantDirty_;
+
+    visible_ = source->visible_;
+    selfVisible_ = source->selfVisible_;
+    menuVisible_ = source->menuVisible_;
+    provider_ = source->provider_;
+    populated_ = source->populated_;
+    if(modified_ != source->modified_)
+    {
+        modified_ = source->modified_;
+        addModified(modified_ ? 1 : -1, false);
+    }
+}
+
+void QtProperty::attachChild(QtProperty *child)
+{
+    assert(child->getParent() == NULL);
+
+    child->parent_ = this;
+    child->index_ = children_.size();
+    children_.push_back(child);
+    insertIndex(indexEntries(child));
+    addModified(child->modifiedCount_, false);
+
+    onChildAdd(child);
+}
+
+void QtProperty::destroy()
+{
+    // a single removal notification for the whole subtree.
+    if(parent_ != NULL)
+    {
+        removeFromParent();
+    }
+    else
+    {
+        if(notifier_ != NULL)
+        {
+            emit notifier_->signalPropertyRemoved(this, NULL);
+        }
+        if(factory_ != NULL)
+        {
+            factory_->dispatchPropertyRemove(this, NULL);
+        }
+    }
+
+    destroying_ = true;
+    delete this;
+}
+
+void QtProperty::deleteHiddenChild(QtProperty *child)
+{
+    if(destroying_)
+    {
+        child->parent_ = NULL;
+        child->destroying_ = true;
+    }
+    delete child;
+}
+
+QtProperty* QtProperty::findChild(const QString &name)
+{
+    populate();
+
+    // duplicated names are rare, only then scan to return the first one.
+    if(nameIndex_.count(name) <= 1)
+    {
+        return nameIndex_.value(name, NULL);
+    }
+
+    foreach(QtProperty *child, children_)
+    {
+        if(child->getName() == name)
+        {
+            return child;
+        }
+    }
+    return NULL;
+}
+
+QtProperty* QtProperty::findDirectChild(const QString &name)
+{
+    populate();
+
+    // the index of a group also holds the names of nested groups.
+    QtProperty *result = NULL;
+    bool duplicated = false;
+    for(NameIndex::const_iterator it = nameIndex_.constFind(name); it != nameIndex_.constEnd() && it.key() == name; ++it)
+    {
+        if(it.value()->parent_ == this)
+        {
+            duplicated = result != NULL;
+            result = it.value();
+            if(duplicated)
+            {
+                break;
+            }
+        }
+    }
+    if(!duplicated)
+    {
+        return result;
+    }
+
+    foreach(QtProperty *child, children_)
+    {
+        if(child->getName() == name)
+        {
+            return child;
+        }
+    }
+    return NULL;
+}
+
+QtProperty* QtProperty::findByPath(const QString &path)
+{
+    QtProperty *property = this;
+    foreach(const QString &name, path.split('/', QString::SkipEmptyParts))
+    {
+        property = property->findDirectChild(name);
+        if(property == NULL)
+        {
+            break;
+        }
+    }
+    return property;
+}
+
+void QtProperty::setChildValue(const QString &name, const QVariant &value)
+{
+    QtProperty *child = findChild(name);
+    if(child != NULL)
+    {
+        child->setValue(value);
+    }
+}
+
+void QtProperty::onChildAdd(QtProperty* /*child*/)
+{
+
+}
+
+QtProperty::NameIndex QtProperty::indexEntries(QtProperty *child) const
+{
+    NameIndex entries;
+    if(type_ == QtPropertyType::GROUP && child->getType() == QtPropertyType::GROUP)
+    {
+        entries = child->nameIndex_;
+    }
+    entries.insert(child->getName(), child);
+    return entries;
+}
+
+bool QtProperty::isIndexForwarded() const
+{
+    // a group's index is merged into the parent's index, only when the parent is a group too.
+    return type_ == QtPropertyType::GROUP &&
+        parent_ != NULL && parent_->getType() == QtPropertyType::GROUP;
+}
+
+void QtProperty::insertIndex(const NameIndex &entries)
+{
+    for(NameIndex::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+        nameIndex_.insert(it.key(), it.value());
+    }
+
+    if(isIndexForwarded())
+    {
+        parent_->insertIndex(entries);
+    }
+}
+
+void QtProperty::removeIndex(const NameIndex &entries)
+{
+    for(NameIndex::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+        nameIndex_.remove(it.key(), it.value());
+    }
+
+    if(isIndexForwarded())
+    {
+        parent_->removeIndex(entries);
+    }
 }
 
-QtProperty* QtProperty::findChild(const QString &name)
+void QtProperty::renameIndex(QtProperty *child, const QString &oldName, const QString &newName)
 {
-    foreach(QtProperty *child, children_)
+    nameIndex_.remove(oldName, child);
+    nameIndex_.insert(newName, child);
+
+    if(isIndexForwarded())
     {
-        if(child->getName() == name)
-        {
-            return child;
-        }
+        parent_->renameIndex(child, oldName, newName);
     }
-    return NULL;
 }
 
-void QtProperty::setChildValue(const QString &name, const QVariant &value)
+void QtProperty::onChildRemove(QtProperty* /*child*/)
 {
-    QtProperty *child = findChild(name);
-    if(child != NULL)
-    {
-        child->setValue(value);
-    }
+
 }
 
-void QtProperty::onChildAdd(QtProperty* /*child*/)
+void QtProperty::onChildValueChange(QtProperty* /*child*/)
 {
 
 }
 
-void QtProperty::onChildRemove(QtProperty* /*child*/)
+void QtProperty::onChildrenReorder()
 {
 
 }
@@ -181,23 +1326,31 @@ void QtProperty::onChildRemove(QtProperty* /*child*/)
 /********************************************************************/
 QtContainerProperty::QtContainerProperty(Type type, QtPropertyFactory *factory)
     : QtProperty(type, factory)
+    , settingValue_(false)
+    , valueDirty_(false)
 {
 
 }
 
-void QtContainerProperty::onChildAdd(QtProperty *child)
-{
-    connect(child, SIGNAL(signalValueChange(QtProperty*)), this, SLOT(slotChildValueChange(QtProperty*)));
-}
-
-void QtContainerProperty::onChildRemove(QtProperty *child)
+const QVariant& QtContainerProperty::getValue() const
 {
-    disconnect(child, SIGNAL(signalValueChange(QtProperty*)), this, SLOT(slotChildValueChange(QtProperty*)));
+    // the aggregated value is rebuilt lazily, so a burst of child changes costs one rebuild.
+    if(valueDirty_)
+    {
+        QtContainerProperty *self = const_cast<QtContainerProperty*>(this);
+        self->updateValue();
+        self->valueDirty_ = false;
+    }
+    return value_;
 }
 
 /********************************************************************/
 static void ensureSize(QVariantList &list, int size)
 {
+    if(list.size() < size)
+    {
+        list.reserve(size);
+    }
     while(list.size() < size)
     {
         list.push_back(QVariant());
@@ -212,20 +1365,24 @@ QtListProperty::QtListProperty(Type type, QtPropertyFactory *factory)
 
 void QtListProperty::setValue(const QVariant &value)
 {
-    if(value_ == value)
+    if(getValue() == value)
     {
         return;
     }
 
-    QVariantList valueList = value.toList();
-    ensureSize(valueList, children_.size());
+    values_ = value.toList();
+    ensureSize(values_, children_.size());
+
+    settingValue_ = true;
     for(int i = 0; i < children_.size(); ++i)
     {
-        children_[i]->setValue(valueList[i]);
+        children_[i]->setValue(values_[i]);
     }
-    value_ = valueList;
+    settingValue_ = false;
 
-    emit signalValueChange(this);
+    value_ = values_;
+    valueDirty_ = false;
+    notifyValueChange();
 }
 
 QString QtListProperty::getValueString() const
@@ -241,24 +1398,62 @@ QString QtListProperty::getValueString() const
     return text;
 }
 
-void QtListProperty::slotChildValueChange(QtProperty *child)
+void QtListProperty::onChildValueChange(QtProperty *child)
 {
+    if(settingValue_)
+    {
+        return;
+    }
+
     int i = indexChild(child);
     if(i >= 0)
     {
-        QVariantList valueList = value_.toList();
-        ensureSize(valueList, children_.size());
+        ensureSize(values_, children_.size());
 
-        if(valueList[i] != child->getValue())
+        const QVariant &childValue = child->getValue();
+        if(values_.at(i) != childValue)
         {
-            valueList[i] = child->getValue();
+            // release the copy held by value_, so values_ is modified in place.
+            value_.clear();
+            values_[i] = childValue;
+            valueDirty_ = true;
 
-            value_ = valueList;
-            emit signalValueChange(this);
+            notifyValueChange();
         }
     }
 }
 
+void QtListProperty::onChildrenReorder()
+{
+    // the value follows the order of the children.
+    value_.clear();
+    ensureSize(values_, children_.size());
+    for(int i = 0; i < children_.size(); ++i)
+    {
+        values_[i] = children_[i]->getValue();
+    }
+    valueDirty_ = true;
+
+    notifyValueChange();
+}
+
+void QtListProperty::copyFrom(const QtProperty *source)
+{
+    QtContainerProperty::copyFrom(source);
+
+    const QtListProperty *list = dynamic_cast<const QtListProperty*>(source);
+    if(list != NULL)
+    {
+        values_ = list->values_;
+        valueDirty_ = list->valueDirty_;
+    }
+}
+
+void QtListProperty::updateValue()
+{
+    value_ = values_;
+}
+
 /********************************************************************/
 QtDictProperty::QtDictProperty(Type type, QtPropertyFactory *factory)
     : QtContainerProperty(type, factory)
@@ -268,35 +1463,61 @@ QtDictProperty::QtDictProperty(Type type, QtPropertyFactory *factory)
 
 void QtDictProperty::setValue(const QVariant &value)
 {
-    if(value_ == value)
+    if(getValue() == value)
     {
         return;
     }
     value_ = value;
+    values_ = value.toMap();
+    valueDirty_ = false;
 
-    QVariantMap valueMap = value_.toMap();
+    settingValue_ = true;
     foreach (QtProperty *child, children_)
     {
-        QVariant value = valueMap.value(child->getName());
+        QVariant value = values_.value(child->getName());
         child->setValue(value);
     }
+    settingValue_ = false;
 
-    emit signalValueChange(this);
+    notifyValueChange();
 }
 
-void QtDictProperty::slotChildValueChange(QtProperty *property)
+void QtDictProperty::onChildValueChange(QtProperty *property)
 {
-    QVariantMap valueMap = value_.toMap();
-    QVariant oldValue = valueMap.value(property->getName());
-    if(property->getValue() != oldValue)
+    if(settingValue_)
+    {
+        return;
+    }
+
+    const QVariant &childValue = property->getValue();
+    if(values_.value(property->getName()) != childValue)
     {
-        valueMap[property->getName()] = property->getValue();
+        // release the copy held by value_, so values_ is modified in place.
+        value_.clear();
+        values_[property->getName()] = childValue;
+        valueDirty_ = true;
+
+        notifyValueChange();
+    }
+}
+
+void QtDictProperty::copyFrom(const QtProperty *source)
+{
+    QtContainerProperty::copyFrom(source);
 
-        value_ = valueMap;
-        emit signalValueChange(this);
+    const QtDictProperty *dict = dynamic_cast<const QtDictProperty*>(source);
+    if(dict != NULL)
+    {
+        values_ = dict->values_;
+        valueDirty_ = dict->valueDirty_;
     }
 }
 
+void QtDictProperty::updateValue()
+{
+    value_ = values_;
+}
+
 /********************************************************************/
 QtGroupProperty::QtGroupProperty(Type type, QtPropertyFactory *factory)
     : QtContainerProperty(type, factory)
@@ -311,6 +1532,16 @@ void QtGroupProperty::setValue(const QVariant& /*value*/)
 
 QtProperty* QtGroupProperty::findChild(const QString &name)
 {
+    // nested lazy groups add their names to the index once populated.
+    populate();
+
+    // the index covers all nested groups. duplicated names fall back to
+    // the depth first search, to keep returning the first declared one.
+    if(nameIndex_.count(name) <= 1)
+    {
+        return nameIndex_.value(name, NULL);
+    }
+
     QtProperty *result = NULL;
     foreach(QtProperty *child, children_)
     {
@@ -333,23 +1564,30 @@ QtProperty* QtGroupProperty::findChild(const QString &name)
 
 void QtGroupProperty::setChildValue(const QString &name, const QVariant &value)
 {
-    foreach(QtProperty *child, children_)
+    // copy the matches, setting a value may change the tree.
+    QtPropertyList matches = nameIndex_.values(name).toVector();
+    foreach(QtProperty *child, matches)
     {
-        if(child->getType() ==  QtPropertyType::GROUP)
-        {
-            child->setChildValue(name, value);
-        }
-        else if(name == child->getName())
+        if(child->getType() != QtPropertyType::GROUP)
         {
             child->setValue(value);
         }
     }
 }
 
-void QtGroupProperty::slotChildValueChange(QtProperty *property)
+void QtGroupProperty::onChildValueChange(QtProperty *property)
 {
-    // emit signal to listner directly.
-    emit signalValueChange(property);
+    // emit signal to listner directly, and pass it on through the enclosing groups.
+    if(notifier_ != NULL)
+    {
+        emit notifier_->signalValueChange(property);
+    }
+
+    QtGroupProperty *parent = dynamic_cast<QtGroupProperty*>(parent_);
+    if(parent != NULL)
+    {
+        parent->onChildValueChange(property);
+    }
 }
 
 
@@ -362,8 +1600,8 @@ QtEnumProperty::QtEnumProperty(Type type, QtPropertyFactory *factory)
 
 QString QtEnumProperty::getValueString() const
 {
-    int index = value_.toInt();
-    QStringList enumNames = attributes_.value(QtAttributeName::EnumName).toStringList();
+    int index = getIntValue();
+    QStringList enumNames = definition_.getAttribute(QtAttributeName::ENUM_NAME).toStringList();
     if(index >= 0 && index < enumNames.size())
     {
         return enumNames[index];
@@ -380,8 +1618,8 @@ QtFlagProperty::QtFlagProperty(Type type, QtPropertyFactory *factory)
 
 QString QtFlagProperty::getValueString() const
 {
-    int value = value_.toInt();
-    QStringList enumNames = attributes_.value(QtAttributeName::FlagName).toStringList();
+    int value = getIntValue();
+    QStringList enumNames = definition_.getAttribute(QtAttributeName::FLAG_NAME).toStringList();
 
     QStringList selected;
     for(int i = 0; i < enumNames.size(); ++i)
@@ -403,12 +1641,12 @@ QtBoolProperty::QtBoolProperty(Type type, QtPropertyFactory *factory)
 
 QString QtBoolProperty::getValueString() const
 {
-    return value_.toBool() ? "True" : "False";
+    return getBoolValue() ? "True" : "False";
 }
 
 QIcon QtBoolProperty::getValueIcon() const
 {
-    return QtPropertyBrowserUtils::drawCheckBox(value_.toBool());
+    return QtPropertyBrowserUtils::drawCheckBox(getBoolValue());
 }
 
 /********************************************************************/
@@ -420,9 +1658,9 @@ QtDoubleProperty::QtDoubleProperty(Type type, QtPropertyFactory *factory)
 
 QString QtDoubleProperty::getValueString() const
 {
-    QVariant v = getAttribute(QtAttributeName::Decimals);
+    QVariant v = getAttribute(QtAttributeName::DECIMALS);
     int decimals = v.type() == QVariant::Int ? v.toInt() : 2;
-    return QLocale::system().toString(value_.toDouble(), 'f', decimals);
+    return QLocale::system().toString(getDoubleValue(), 'f', decimals);
 }
 
 /********************************************************************/
@@ -434,31 +1672,65 @@ QtColorProperty::QtColorProperty(Type type, QtPropertyFactory *factory)
 
 QString QtColorProperty::getValueString() const
 {
-    QColor color = QtPropertyBrowserUtils::variant2color(value_);
+    QColor color = getColorValue();
     return QtPropertyBrowserUtils::colorValueText(color);
 }
 
 QIcon QtColorProperty::getValueIcon() const
 {
-    QColor color = QtPropertyBrowserUtils::variant2color(value_);
+    QColor color = getColorValue();
     return QtPropertyBrowserUtils::brushValueIcon(QBrush(color));
 }
 
 /********************************************************************/
+// "valueType" may be given either as a type id or as a type name.
+static QtPropertyType::Type variant2type(const QVariant &value)
+{
+    if(value.type() == QVariant::String)
+    {
+        return QtPropertyType::registerType(value.toString());
+    }
+    return value.toInt();
+}
+
 QtDynamicListProperty::QtDynamicListProperty(Type type, QtPropertyFactory *factory)
     : QtProperty(type, factory)
     , length_(0)
+    , prototype_(NULL)
 {
-    propLength_ = factory_->createProperty(QtPropertyType::INT);
+    propLength_ = createProperty(QtPropertyType::INT);
     propLength_->setName("length");
-    propLength_->setTitle(tr("Length"));
-    propLength_->setAttribute(QtAttributeName::MinValue, 0);
+    propLength_->setTitle(QCoreApplication::translate("QtDynamicListProperty", "Length"));
+    propLength_->setAttribute(QtAttributeName::MIN_VALUE, 0);
     addChild(propLength_);
-    connect(propLength_, SIGNAL(signalValueChange(QtProperty*)), this, SLOT(slotLengthChange(QtProperty*)));
 }
 
 QtDynamicListProperty::~QtDynamicListProperty()
 {
+    delete prototype_;
+}
+
+void QtDynamicListProperty::setAttribute(QtAttributeName::Atom atom, const QVariant &value)
+{
+    QtProperty::setAttribute(atom, value);
+
+    if(atom == QtAttributeName::VALUE_TYPE ||
+       atom == QtAttributeName::VALUE_DEFAULT ||
+       atom == QtAttributeName::VALUE_ATTRIBUTES)
+    {
+        resetPrototype();
+    }
+}
+
+void QtDynamicListProperty::onDefinitionChange()
+{
+    resetPrototype();
+}
+
+void QtDynamicListProperty::resetPrototype()
+{
+    delete prototype_;
+    prototype_ = NULL;
 }
 
 void QtDynamicListProperty::setValue(const QVariant &value)
@@ -468,6 +1740,9 @@ void QtDynamicListProperty::setValue(const QVariant &value)
         return;
     }
 
+    // the value changes of the items are merged, the list reports once.
+    QtPropertyUpdateGuard guard(this);
+
     QVariantList valueList = value.toList();
     setLength(valueList.size());
 
@@ -478,7 +1753,7 @@ void QtDynamicListProperty::setValue(const QVariant &value)
     }
 
     value_ = valueList_;
-    emit signalValueChange(this);
+    notifyValueChange();
 }
 
 QString QtDynamicListProperty::getValueString() const
@@ -493,21 +1768,96 @@ QString QtDynamicListProperty::getValueString() const
     return ret;
 }
 
-void QtDynamicListProperty::slotItemValueChange(QtProperty *item)
+void QtDynamicListProperty::onChildValueChange(QtProperty *child)
+{
+    if(child == propLength_)
+    {
+        onLengthChange(child);
+    }
+    else
+    {
+        onItemValueChange(child);
+    }
+}
+
+void QtDynamicListProperty::copyFrom(const QtProperty *source)
+{
+    // the prototype was built from the old attributes.
+    resetPrototype();
+
+    const QtDynamicListProperty *list = dynamic_cast<const QtDynamicListProperty*>(source);
+    if(list == NULL)
+    {
+        QtProperty::copyFrom(source);
+        return;
+    }
+
+    // the length property made by the constructor stays, only its state is copied.
+    copyState(list);
+    copyInto(propLength_, list->propLength_);
+
+    length_ = list->length_;
+    valueList_ = list->valueList_;
+    items_.reserve(list->items_.size());
+    foreach(QtProperty *child, list->children_)
+    {
+        if(child != list->propLength_)
+        {
+            QtProperty *item = child->clone();
+            items_.push_back(item);
+            attachChild(item);
+        }
+    }
+}
+
+void QtDynamicListProperty::onChildrenReorder()
+{
+    items_.clear();
+    valueList_.clear();
+    foreach(QtProperty *child, children_)
+    {
+        if(child != propLength_)
+        {
+            child->setName(QString::number(items_.size()));
+            items_.push_back(child);
+            valueList_.push_back(child->getValue());
+        }
+    }
+    value_ = valueList_;
+
+    notifyValueChange();
+}
+
+int QtDynamicListProperty::itemIndex(QtProperty *item) const
+{
+    int i = indexChild(item);
+    int lengthIndex = indexChild(propLength_);
+    if(i >= 0 && lengthIndex >= 0 && lengthIndex < i)
+    {
+        --i;
+    }
+    return i;
+}
+
+void QtDynamicListProperty::onItemValueChange(QtProperty *item)
 {
-    int i = items_.indexOf(item);
+    int i = itemIndex(item);
+    if(i < 0)
+    {
+        return;
+    }
     if(valueList_[i] != item->getValue())
     {
         valueList_[i] = item->getValue();
         value_ = valueList_;
 
-        emit signalValueChange(this);
+        notifyValueChange();
     }
 }
 
-void QtDynamicListProperty::slotItemMoveUp(QtProperty *item)
+void QtDynamicListProperty::moveItemUp(QtProperty *item)
 {
-    int i = items_.indexOf(item);
+    int i = itemIndex(item);
     if(i <= 0)
     {
         return;
@@ -518,10 +1868,10 @@ void QtDynamicListProperty::slotItemMoveUp(QtProperty *item)
     item->setValue(value);
 }
 
-void QtDynamicListProperty::slotItemMoveDown(QtProperty *item)
+void QtDynamicListProperty::moveItemDown(QtProperty *item)
 {
-    int i = items_.indexOf(item);
-    if(i + 1 >= items_.size())
+    int i = itemIndex(item);
+    if(i < 0 || i + 1 >= items_.size())
     {
         return;
     }
@@ -531,9 +1881,13 @@ void QtDynamicListProperty::slotItemMoveDown(QtProperty *item)
     item->setValue(value);
 }
 
-void QtDynamicListProperty::slotItemDelete(QtProperty *item)
+void QtDynamicListProperty::deleteItem(QtProperty *item)
 {
-    int i = items_.indexOf(item);
+    int i = itemIndex(item);
+    if(i < 0)
+    {
+        return;
+    }
     for(; i < items_.size() - 1; ++i)
     {
         items_[i]->setValue(items_[i + 1]->getValue());
@@ -542,12 +1896,12 @@ void QtDynamicListProperty::slotItemDelete(QtProperty *item)
     setLength(length_ - 1);
 }
 
-void QtDynamicListProperty::slotLengthChange(QtProperty *property)
+void QtDynamicListProperty::onLengthChange(QtProperty *property)
 {
-    int length = property->getValue().toInt();
+    int length = property->getIntValue();
     setLength(length);
 
-    emit signalValueChange(this);
+    notifyValueChange();
 }
 
 void QtDynamicListProperty::setLength(int length)
@@ -558,45 +1912,64 @@ void QtDynamicListProperty::setLength(int length)
         return;
     }
 
-    while(length_ < length)
+    if(length_ < length)
     {
-        appendItem();
-        ++length_;
+        QtPropertyList added;
+        added.reserve(length - length_);
+        items_.reserve(length);
+        valueList_.reserve(length);
+
+        while(length_ < length)
+        {
+            QtProperty *item = createItem();
+            item->setName(QString::number(length_));
+            items_.push_back(item);
+            valueList_.push_back(item->getValue());
+            added.push_back(item);
+            ++length_;
+        }
+
+        // one notification for the whole range.
+        insertChildren(children_.size(), added);
     }
     while(length_ > length)
     {
         popItem();
         --length_;
     }
-    propLength_->setValue(length_);
     value_ = valueList_;
+    propLength_->setIntValue(length_);
 }
 
-QtProperty* QtDynamicListProperty::appendItem()
+QtDynamicItemProperty* QtDynamicListProperty::getPrototype()
 {
-    QtDynamicItemProperty *prop = dynamic_cast<QtDynamicItemProperty*>(factory_->createProperty(QtPropertyType::DYNAMIC_ITEM));
-    prop->setName(QString::number(items_.size()));
-    prop->setValueType(getAttribute("valueType").toString());
-
-    QVariant valueDefault = getAttribute("valueDefault");
-    prop->setValue(valueDefault);
-
-    QVariantMap attr = getAttribute("valueAttributes").toMap();
-    for(QVariantMap::iterator it = attr.begin(); it != attr.end(); ++it)
+    if(prototype_ == NULL)
     {
-       prop->getImpl()->setAttribute(it.key(), it.value());
+        prototype_ = dynamic_cast<QtDynamicItemProperty*>(createProperty(QtPropertyType::DYNAMIC_ITEM));
+        prototype_->setValueType(variant2type(getAttribute(QtAttributeName::VALUE_TYPE)));
+        prototype_->setValue(getAttribute(QtAttributeName::VALUE_DEFAULT));
+
+        QVariantMap attr = getAttribute(QtAttributeName::VALUE_ATTRIBUTES).toMap();
+        for(QVariantMap::iterator it = attr.begin(); it != attr.end(); ++it)
+        {
+           prototype_->getImpl()->setAttribute(it.key(), it.value());
+        }
     }
+    return prototype_;
+}
 
-    connect(prop, SIGNAL(signalValueChange(QtProperty*)), this, SLOT(slotItemValueChange(QtProperty*)));
-    connect(prop, SIGNAL(signalMoveUp(QtProperty*)), this, SLOT(slotItemMoveUp(QtProperty*)));
-    connect(prop, SIGNAL(signalMoveDown(QtProperty*)), this, SLOT(slotItemMoveDown(QtProperty*)));
-    connect(prop, SIGNAL(signalDelete(QtProperty*)), this, SLOT(slotItemDelete(QtProperty*)));
+QtProperty* QtDynamicListProperty::createItem()
+{
+    QtDynamicItemProperty *prototype = getPrototype();
+    QtProperty *impl = prototype->getImpl();
 
-    valueList_.append(valueDefault);
-    items_.append(prop);
+    QtDynamicItemProperty *item = dynamic_cast<QtDynamicItemProperty*>(createProperty(QtPropertyType::DYNAMIC_ITEM));
+    item->setValueType(impl->getType());
 
-    this->addChild(prop);
-    return prop;
+    // the attributes are shared with the prototype, not applied one by one.
+    item->getImpl()->setDefinition(impl->getDefinition());
+    item->getImpl()->setScalarValue(impl->getScalarValue());
+    return item;
 }
 
 void QtDynamicListProperty::popItem()
@@ -621,7 +1994,7 @@ QtDynamicItemProperty::~QtDynamicItemProperty()
 {
     if(impl_ != NULL)
     {
-        delete impl_;
+        deleteHiddenChild(impl_);
     }
 }
 
@@ -635,10 +2008,10 @@ void QtDynamicItemProperty::setValueType(Type type)
         }
         delete impl_;
     }
-    impl_ = factory_->createProperty(type);
+    impl_ = createProperty(type);
     assert(impl_ != NULL);
 
-    connect(impl_, SIGNAL(signalValueChange(QtProperty*)), this, SLOT(onImplValueChange(QtProperty*)));
+    adoptHiddenChild(impl_);
 }
 
 void QtDynamicItemProperty::setValue(const QVariant &value)
@@ -646,14 +2019,69 @@ void QtDynamicItemProperty::setValue(const QVariant &value)
     impl_->setValue(value);
 }
 
-void QtDynamicItemProperty::onImplValueChange(QtProperty *property)
+void QtDynamicItemProperty::moveUp()
+{
+    if(notifier_ != NULL)
+    {
+        emit notifier_->signalMoveUp(this);
+    }
+
+    QtDynamicListProperty *list = dynamic_cast<QtDynamicListProperty*>(parent_);
+    if(list != NULL)
+    {
+        list->moveItemUp(this);
+    }
+}
+
+void QtDynamicItemProperty::moveDown()
+{
+    if(notifier_ != NULL)
+    {
+        emit notifier_->signalMoveDown(this);
+    }
+
+    QtDynamicListProperty *list = dynamic_cast<QtDynamicListProperty*>(parent_);
+    if(list != NULL)
+    {
+        list->moveItemDown(this);
+    }
+}
+
+void QtDynamicItemProperty::remove()
+{
+    if(notifier_ != NULL)
+    {
+        emit notifier_->signalDelete(this);
+    }
+
+    QtDynamicListProperty *list = dynamic_cast<QtDynamicListProperty*>(parent_);
+    if(list != NULL)
+    {
+        list->deleteItem(this);
+    }
+}
+
+void QtDynamicItemProperty::copyFrom(const QtProperty *source)
+{
+    QtProperty::copyFrom(source);
+
+    const QtDynamicItemProperty *item = dynamic_cast<const QtDynamicItemProperty*>(source);
+    if(item != NULL && item->impl_ != NULL)
+    {
+        setValueType(item->impl_->getType());
+        copyInto(impl_, item->impl_);
+    }
+}
+
+void QtDynamicItemProperty::onChildValueChange(QtProperty * /*child*/)
 {
-    emit signalValueChange(this);
+    notifyValueChange();
 }
 
 /********************************************************************/
 QtFloatListProperty::QtFloatListProperty(Type type, QtPropertyFactory *factory)
     : QtProperty(type, factory)
+    , differCount_(0)
 {
 
 }
@@ -663,27 +2091,172 @@ QtFloatListProperty::~QtFloatListProperty()
 
 }
 
+void QtFloatListProperty::setValue(const QVariant &value)
+{
+    if(value.userType() == qMetaTypeId< QVector<float> >())
+    {
+        setValues(value.value< QVector<float> >());
+        return;
+    }
+
+    QVariantList lst = value.toList();
+    QVector<float> values(lst.size());
+    for(int i = 0; i < lst.size(); ++i)
+    {
+        values[i] = lst[i].toFloat();
+    }
+    setValues(values);
+}
+
+const QVariant& QtFloatListProperty::getValue() const
+{
+    if(variantDirty_)
+    {
+        QVariantList lst;
+        lst.reserve(values_.size());
+        foreach(float v, values_)
+        {
+            lst.push_back(QVariant((double)v));
+        }
+
+        QtFloatListProperty *self = const_cast<QtFloatListProperty*>(this);
+        self->value_ = lst;
+        self->variantDirty_ = false;
+    }
+    return value_;
+}
+
+void QtFloatListProperty::setValues(const QVector<float> &values)
+{
+    if(values_ == values)
+    {
+        return;
+    }
+    values_ = values;
+    countDifferences();
+    variantDirty_ = true;
+    notifyValueChange();
+}
+
+void QtFloatListProperty::setValues(const float *data, int count)
+{
+    if(values_.size() == count && std::equal(data, data + count, values_.constBegin()))
+    {
+        return;
+    }
+    values_.resize(count);
+    std::copy(data, data + count, values_.begin());
+    countDifferences();
+    variantDirty_ = true;
+    notifyValueChange();
+}
+
+void QtFloatListProperty::setValueAt(int index, float value)
+{
+    if(index < 0)
+    {
+        return;
+    }
+    if(index < values_.size() && values_.at(index) == value)
+    {
+        return;
+    }
+
+    if(index >= values_.size())
+    {
+        values_.resize(index + 1);
+        values_[index] = value;
+        countDifferences();
+    }
+    else
+    {
+        // only this component can change the count.
+        bool differed = differsFromDefault(index);
+        values_[index] = value;
+        differCount_ += (differsFromDefault(index) ? 1 : 0) - (differed ? 1 : 0);
+    }
+    variantDirty_ = true;
+    notifyValueChange();
+}
+
+void QtFloatListProperty::copyFrom(const QtProperty *source)
+{
+    QtProperty::copyFrom(source);
+
+    const QtFloatListProperty *list = dynamic_cast<const QtFloatListProperty*>(source);
+    if(list != NULL)
+    {
+        values_ = list->values_;
+    }
+    resetDefaults();
+}
+
+bool QtFloatListProperty::isDefaultValue() const
+{
+    return differCount_ == 0;
+}
+
+void QtFloatListProperty::onDefinitionChange()
+{
+    resetDefaults();
+}
+
+void QtFloatListProperty::onDefaultValueChange()
+{
+    resetDefaults();
+}
+
+void QtFloatListProperty::resetDefaults()
+{
+    const QVariant &defaultValue = definition_.getDefaultValue();
+    if(defaultValue.userType() == qMetaTypeId<QVector<float> >())
+    {
+        defaults_ = defaultValue.value<QVector<float> >();
+    }
+    else
+    {
+        QVariantList list = defaultValue.toList();
+        defaults_.resize(list.size());
+        for(int i = 0; i < list.size(); ++i)
+        {
+            defaults_[i] = (float)list[i].toDouble();
+        }
+    }
+    countDifferences();
+}
+
+void QtFloatListProperty::countDifferences()
+{
+    differCount_ = 0;
+    int count = std::max(values_.size(), defaults_.size());
+    for(int i = 0; i < count; ++i)
+    {
+        if(differsFromDefault(i))
+        {
+            ++differCount_;
+        }
+    }
+}
+
+bool QtFloatListProperty::differsFromDefault(int index) const
+{
+    return index >= values_.size() || index >= defaults_.size() || values_.at(index) != defaults_.at(index);
+}
+
 QString QtFloatListProperty::getValueString() const
 {
-    int size = getAttribute(QtAttributeName::Size).toInt();
+    int size = getAttribute(QtAttributeName::SIZE).toInt();
 
     QString ret;
     ret += "[";
 
-    QVariantList lst = value_.toList();
     for(int i = 0; i < size; ++i)
     {
         if(i != 0)
         {
             ret += ", ";
         }
-
-        double v = 0.0;
-        if(i < lst.size())
-        {
-            v = lst[i].toDouble();
-        }
-        ret += QString::number(v);
+        ret += QString::number(i < values_.size() ? values_.at(i) : 0.0f);
     }
 
     ret += "]";
@@ -2,61 +2,213 @@
 #define QTPROPERTY_H
 
 #include "qtpropertyconfig.h"
+#include "qtpropertytype.h"
+#include "qtpropertydefinition.h"
+#include "qtpropertyvalue.h"
 #include <QObject>
+#include <QPointer>
 #include <QVector>
 #include <QVariant>
-#include <QMap>
+#include <QMultiHash>
 #include <QIcon>
+#include <algorithm>
 
 class QtProperty;
+class QtPropertyNotifier;
 class QtPropertyFactory;
+class QtPropertyUpdateBatch;
+class QtPropertyArena;
+class QtDynamicItemProperty;
 
 typedef QVector<QtProperty*>    QtPropertyList;
-typedef QMap<QString, QVariant> QtPropertyAttributes;
 
-class QTPROPERTYSHEET_DLL QtProperty : public QObject
+/**
+ * @brief The QtPropertyChildProvider class
+ *
+ * Creates the children of lazy properties on demand. A lazy property only
+ * declares that it has children; the provider creates them the first time the
+ * property is expanded in a browser, or searched with findChild/findByPath.
+ * Until then the children do not exist, so walks over getChildren() such as
+ * saving or cloning only see the populated part of the tree.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyChildProvider
+{
+public:
+    virtual ~QtPropertyChildProvider(){}
+
+    /** 为property创建子属性。一次加入的子属性最好用insertChildren，只发出一次通知。*/
+    virtual void populateChildren(QtProperty *property) = 0;
+
+    /** 子属性能否释放后重新创建。返回true表示provider的数据源保存了子属性的值，
+     *  重新populate得到相同的子属性；默认返回false，子属性从不被释放。
+     */
+    virtual bool canReleaseChildren(QtProperty * /*property*/){ return false; }
+
+    /** property的子属性已被释放并delete。子属性上没有写回数据源的修改随之丢失，
+     *  所以只有canReleaseChildren返回true、子孙属性没有被修改、并且没有listener
+     *  正在使用时才会释放。
+     */
+    virtual void onChildrenReleased(QtProperty * /*property*/){}
+};
+
+/**
+ * @brief The QtPropertyNotifier class
+ *
+ * QObject facade of a property, for code that wants Qt signals. Properties
+ * themselves are plain objects; the notifier is created the first time
+ * QtProperty::getNotifier() is called and deleted together with its property,
+ * so the nodes nobody connects to never pay for a QObject. Code watching many
+ * properties should register a QtPropertyListener on the factory instead.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyNotifier : public QObject
 {
     Q_OBJECT
 public:
-    typedef QString Type;
+    explicit QtPropertyNotifier(QtProperty *property) : property_(property) {}
+
+    QtProperty* getProperty() const { return property_; }
+
+signals:
+    void signalValueChange(QtProperty *property);
+    void signalPropertyInserted(QtProperty *property, QtProperty *parent);
+    void signalPropertyRemoved(QtProperty *property, QtProperty *parent);
+    void signalPropertyReordered(QtProperty *property);
+    void signalChildrenInserted(QtProperty *parent, int first, int last);
+    void signalAttributeChange(QtProperty *property, int atom);
+    void signalPropertyChange(QtProperty *property);
+    void signalPopupMenu(QtProperty *property);
+
+    /** QtDynamicItemProperty请求所在的列表移动或删除自己。*/
+    void signalMoveUp(QtProperty *property);
+    void signalMoveDown(QtProperty *property);
+    void signalDelete(QtProperty *property);
+
+    /** 属性即将被delete，属性树中的子孙属性仍然存在。*/
+    void signalDestroyed(QtProperty *property);
+
+private:
+    QtProperty* property_;
+};
+
+/** QtPropertyPointer共享的控制块，属性被delete时property被清空。*/
+struct QtPropertyWeakRef
+{
+    QtProperty* property;
+    int         refCount;
+};
+
+/**
+ * @brief The QtProperty class
+ *
+ * Node of a property tree: tree links, definition and value, without any
+ * QObject. Changes are reported to the parent, to the listeners of the
+ * factory and, only if somebody asked for it, to the QtPropertyNotifier.
+ */
+class QTPROPERTYSHEET_DLL QtProperty
+{
+public:
+    typedef QtPropertyType::Type Type;
 
     QtProperty(Type type, QtPropertyFactory *factory);
     virtual ~QtProperty();
 
+    /** 属性可以分配在arena上，arena为NULL时从堆上分配。delete时自动区分。*/
+    static void* operator new(size_t size);
+    static void* operator new(size_t size, QtPropertyArena *arena);
+    static void operator delete(void *p);
+    static void operator delete(void *p, QtPropertyArena *arena);
+
     Type getType() const { return type_; }
+    /** 创建本属性的factory，factory先被销毁时返回NULL。*/
+    QtPropertyFactory* getFactory() const { return factory_; }
+    QString getTypeName() const { return QtPropertyType::typeName(type_); }
     QtProperty* getParent() { return parent_; }
 
     void setName(const QString &name);
-    const QString& getName() const { return name_; }
+    const QString& getName() const { return definition_.getName(); }
 
     void setTitle(const QString &title);
     const QString& getTitle() const;
 
-    void setToolTip(const QString &tip){ tips_ = tip; }
-    const QString& getToolTip() const {return tips_; }
+    void setToolTip(const QString &tip){ definition_.setToolTip(tip); }
+    const QString& getToolTip() const {return definition_.getToolTip(); }
+
+    void setBackgroundColor(const QColor &cr){ definition_.setBackgroundColor(cr); }
+    const QColor& getBackgroundColor() const { return definition_.getBackgroundColor(); }
 
-    void setBackgroundColor(const QColor &cr){ bgColor_ = cr; }
-    const QColor& getBackgroundColor() const { return bgColor_; }
+    /** 共享的属性定义。修改名称、标题、属性等会使本实例脱离共享。*/
+    const QtPropertyDefinition& getDefinition() const { return definition_; }
+    void setDefinition(const QtPropertyDefinition &definition);
 
     virtual void setValue(const QVariant &value);
-    virtual const QVariant& getValue() const { return value_; }
+    virtual const QVariant& getValue() const;
+
+    /** 标量值。bool、int、enum、flag、float和color属性的值保存为QtPropertyValue，
+     *  通过这组接口读写不需要构造和比较QVariant。其它属性在这里转换getValue的结果。
+     */
+    virtual void setScalarValue(const QtPropertyValue &value);
+    virtual QtPropertyValue getScalarValue() const;
+
+    void setIntValue(qint64 value){ setScalarValue(QtPropertyValue(value)); }
+    qint64 getIntValue() const { return getScalarValue().toInt(); }
+
+    void setDoubleValue(double value){ setScalarValue(QtPropertyValue(value)); }
+    double getDoubleValue() const { return getScalarValue().toDouble(); }
+
+    void setBoolValue(bool value){ setScalarValue(QtPropertyValue(value)); }
+    bool getBoolValue() const { return getScalarValue().toBool(); }
+
+    void setColorValue(const QColor &value){ setScalarValue(QtPropertyValue(value)); }
+    QColor getColorValue() const { return getScalarValue().toColor(); }
+
+    /** 值的存储类型，VARIANT表示值保存在QVariant中。*/
+    QtPropertyValue::Kind getValueKind() const { return valueKind_; }
 
     virtual QString getValueString() const;
     virtual QIcon getValueIcon() const;
 
-    virtual void setAttribute(const QString &name, const QVariant &value);
+    virtual void setAttribute(QtAttributeName::Atom atom, const QVariant &value);
+    QVariant getAttribute(QtAttributeName::Atom atom) const { return definition_.getAttribute(atom); }
+    const QtPropertyAttributes& getAttributes() const { return definition_.getAttributes(); }
+
+    /** 按名称访问属性，兼容字符串名称。*/
+    void setAttribute(const QString &name, const QVariant &value);
     QVariant getAttribute(const QString &name) const;
-    QtPropertyAttributes& getAttributes(){ return attributes_; }
 
     /** 添加子属性，由属性树负责delete child。*/
     void addChild(QtProperty *child);
 
+    /** 在index位置插入子属性，index超出范围时添加到末尾。*/
+    void insertChild(int index, QtProperty *child);
+
+    /** 在index位置一次插入多个子属性。factory的监听者只收到一次onChildrenInsert；
+     *  notifier先为每个子属性发出signalPropertyInserted，再发出signalChildrenInserted。
+     */
+    void insertChildren(int index, const QtPropertyList &children);
+
+    /** 把from位置的子属性移动到to位置，发出signalPropertyReordered。*/
+    void moveChild(int from, int to);
+
+    /** 按lessThan对子属性稳定排序，发出signalPropertyReordered。*/
+    template<typename LessThan>
+    void sortChildren(LessThan lessThan);
+
     /** 移除子属性，不delete child。*/
     void removeChild(QtProperty *child);
 
     /** 将自己从属性树中取下，不delete自己。*/
     void removeFromParent();
 
+    /** 深复制整棵子树，包括结构、属性定义和值。复制过程不发出任何信号，
+     *  新的树没有父属性，调用者负责把它加入属性树或delete。
+     */
+    QtProperty* clone() const;
+
+    /** 从属性树中取下并delete整棵子树。只为根发出一次移除通知，
+     *  子孙属性被静默删除，适合快速销毁大的属性树。
+     */
+    void destroy();
+
     /** 移除所有子属性。
      *  @param clean 如果为true，则delete所有子属性。否则，仅从树中移除引用。
      */
@@ -64,13 +216,63 @@ public:
 
     QtPropertyList& getChildren(){ return children_; }
     const QtPropertyList& getChildren() const { return children_; }
+    /** child的位置，不是子属性时返回-1。*/
     int indexChild(const QtProperty *child) const;
     virtual QtProperty* findChild(const QString &name);
 
+    /** 只查找直接子属性。group的findChild会搜索嵌套的group，这里不会。*/
+    QtProperty* findDirectChild(const QString &name);
+
+    /** 按路径查找子孙属性，路径以'/'分隔，如"information/age"。
+     *  每一段都通过findDirectChild查找，找不到则返回NULL。
+     */
+    QtProperty* findByPath(const QString &path);
+
     virtual void setChildValue(const QString &name, const QVariant &value);
 
     virtual bool hasValue() const { return true; }
-    virtual bool isModified() const { return false; }
+
+    /** 子属性是否由本属性根据自己的值生成，如QtDynamicListProperty。
+     *  保存属性树时这类属性只保存值，不保存子属性。
+     */
+    virtual bool hasGeneratedChildren() const { return false; }
+
+    /** 设置子属性的provider，属性成为懒加载的。已有的子属性视为已经创建。
+     *  provider由调用者管理，必须比属性存在得更久。
+     */
+    void setChildProvider(QtPropertyChildProvider *provider);
+    QtPropertyChildProvider* getChildProvider() const { return provider_; }
+
+    /** 有子属性，或者有尚未创建的懒加载子属性。*/
+    bool hasChildren() const { return !children_.isEmpty() || !isPopulated(); }
+    bool isPopulated() const { return provider_ == NULL || populated_; }
+
+    /** 通过provider创建子属性，已经创建过时什么也不做。*/
+    void populate();
+
+    /** delete懒加载的子属性，下次populate时重新创建。子属性的值应当由provider的
+     *  数据源保存。provider不允许、子孙属性被修改、或者factory的listener仍在使用时
+     *  不释放，返回false。
+     */
+    bool releaseChildren();
+
+    /** ancestor是本属性或本属性的祖先。*/
+    bool isInSubtreeOf(const QtProperty *ancestor) const;
+
+    /** 值与属性定义中的默认值不同。没有默认值的属性和容器属性本身不会被修改，
+     *  容器的修改状态来自子孙属性。
+     */
+    bool isSelfModified() const { return modified_; }
+
+    /** 本属性及子孙属性中被修改的数量，值变化时增量维护，查询是O(1)的。*/
+    int getModifiedCount() const { return modifiedCount_; }
+    virtual bool isModified() const { return modifiedCount_ > 0; }
+
+    const QVariant& getDefaultValue() const { return definition_.getDefaultValue(); }
+    void setDefaultValue(const QVariant &value);
+
+    /** 把子树中被修改的属性恢复为默认值。只访问被修改的分支，并在一次批量更新中完成。*/
+    void resetToDefault();
 
     void setVisible(bool visible);
     bool isVisible() const { return visible_; }
@@ -81,80 +283,297 @@ public:
     void setMenuVisible(bool visible){ menuVisible_ = visible; }
     bool isMenuVisible() const { return menuVisible_; }
 
-signals:
-    void signalValueChange(QtProperty *property);
-    void signalPropertyInserted(QtProperty *property, QtProperty *parent);
-    void signalPropertyRemoved(QtProperty *property, QtProperty *parent);
-    void signalPropertyReordered(QtProperty *property);
-    void signalAttributeChange(QtProperty *property, const QString &name);
-    void signalPropertyChange(QtProperty *property);
-    void signalPopupMenu(QtProperty *property);
+    /** 同时编辑多个对象时，各对象的值不同。值本身不变，只影响显示。*/
+    void setMixed(bool mixed);
+    bool isMixed() const { return mixed_; }
+
+    /** 开始批量更新。在对应的endUpdate之前，本属性及其子孙属性的值变化、
+     *  显示变化和attribute变化信号会被推迟，并按属性合并，最外层的endUpdate时统一发出。
+     *  可以嵌套调用。插入、删除子属性的信号不受影响。
+     */
+    void beginUpdate();
+    void endUpdate();
+    bool isUpdating() const { return batch_ != NULL; }
+
+    /** 属性的QObject外观，第一次调用时创建，随属性一起delete。*/
+    QtPropertyNotifier* getNotifier();
+    bool hasNotifier() const { return notifier_ != NULL; }
 
 protected:
     virtual void onChildAdd(QtProperty *child);
     virtual void onChildRemove(QtProperty *child);
 
-    QtPropertyFactory*  factory_;
+    /** 子属性的值发生变化。在子属性通知监听者之前直接调用，不经过信号。*/
+    virtual void onChildValueChange(QtProperty *child);
+
+    /** 子属性的顺序发生变化。*/
+    virtual void onChildrenReorder();
+
+    /** setDefinition替换了整个属性定义。*/
+    virtual void onDefinitionChange(){}
+
+    /** setDefaultValue修改了默认值。*/
+    virtual void onDefaultValueChange(){}
+
+    /** 当前值是否等于默认值，只在有默认值时调用。*/
+    virtual bool isDefaultValue() const;
+
+    /** 把默认值转换为valueKind_保存，比较时不再经过QVariant。*/
+    void cacheDefaultValue();
+
+    /** 重新比较当前值和默认值，修改状态变化时更新祖先的计数。*/
+    void updateModified();
+
+    /** 更新从first开始的子属性的位置，并通知顺序变化。*/
+    void childrenReordered(int first, int last);
+
+    /** 复制source的状态和子属性，不发出信号。子类复制自己的数据后调用基类。*/
+    virtual void copyFrom(const QtProperty *source);
+    static void copyInto(QtProperty *target, const QtProperty *source){ target->copyFrom(source); }
+
+    /** 复制source除子属性以外的状态，不发出信号。*/
+    void copyState(const QtProperty *source);
+
+    /** 不发出信号地添加子属性，用于构造尚未加入属性树的属性。*/
+    void attachChild(QtProperty *child);
+
+    /** 通过factory创建属性。factory已被销毁时创建不依赖factory的普通属性。*/
+    QtProperty* createProperty(Type type) const;
+
+    /** child将变化报告给本属性，但不加入children_，也不显示在属性树中。*/
+    void adoptHiddenChild(QtProperty *child){ child->parent_ = this; addModified(child->modifiedCount_, false); }
+    void deleteHiddenChild(QtProperty *child);
+
+    /** 发出变化信号。处于批量更新中时，信号被推迟到endUpdate。*/
+    void notifyValueChange();
+    void notifyPropertyChange();
+    void notifyAttributeChange(int atom);
+    /** 为新旧属性表中不同的每个atom发出属性变化信号。*/
+    void notifyAttributeDifference(const QtPropertyAttributes &oldAttributes,
+                                   const QtPropertyAttributes &newAttributes);
+
+    typedef QMultiHash<QString, QtProperty*> NameIndex;
+
+    /** 子属性加入本属性名称索引的条目。group的子group会把自己的索引一并带上。*/
+    NameIndex indexEntries(QtProperty *child) const;
+    void insertIndex(const NameIndex &entries);
+    void removeIndex(const NameIndex &entries);
+    void renameIndex(QtProperty *child, const QString &oldName, const QString &newName);
+    bool isIndexForwarded() const;
+
+    /** factory销毁时自动清空，之后属性不再通知factory的监听者。*/
+    QPointer<QtPropertyFactory> factory_;
 
     Type                type_;
-    QString             name_;
-    QString             title_;
-    QString             tips_;
-    QVariant            value_;
-    QColor              bgColor_;
+    QtPropertyDefinition definition_;
+    QVariant            value_;     ///< 标量属性中只是scalar_的缓存
+    QtPropertyValue     scalar_;
+    QtPropertyValue     defaultScalar_; ///< 标量属性的默认值，随定义更新
+    QtPropertyValue::Kind valueKind_;
+    bool                variantDirty_;
 
     QtProperty*         parent_;
     QtPropertyList      children_;
+    mutable int         index_; ///< 在父属性children_中的位置，可能已过时，见staleFrom_
+
+    /** 删除子属性时不给后面的兄弟重新编号。从staleFrom_开始的子属性，index_可能比
+     *  实际位置大，最多大staleShift_。插入子属性时统一重新编号。
+     */
+    int                 staleFrom_;
+    int                 staleShift_;
 
-    QMap<QString, QVariant> attributes_;
+    /** 子属性的名称索引。对于group，还包含经由子group可以到达的所有属性。*/
+    NameIndex           nameIndex_;
 
     bool                visible_;
     bool                selfVisible_;
     bool                menuVisible_;
+    bool                modified_;
+    bool                mixed_;
+    int                 modifiedCount_; ///< 子树中被修改的属性数量，包括自己
+
+    QtPropertyChildProvider* provider_;
+    bool                populated_;
+
+    /** 没有人连接信号时为NULL。*/
+    QtPropertyNotifier* notifier_;
+
+private:
+    Q_DISABLE_COPY(QtProperty)
+
+    bool                destroying_;
+
+    friend class QtPropertyUpdateBatch;
+    friend class QtPropertyPointer;
+    friend class QtPropertySnapshot;
+
+    /** 第一次创建QtPropertyPointer时创建。*/
+    QtPropertyWeakRef* getWeakRef();
+
+    QtPropertyUpdateBatch* findBatch();
+
+    void assignScalar(const QtPropertyValue &value);
+
+    /** 从first和staleFrom_中较小的位置开始重新编号，之后所有位置都是准确的。*/
+    void renumberChildren(int first);
+
+    /** 把delta加到自己和所有祖先的modifiedCount_上。notify为true时，修改状态变化的属性发出显示变化。*/
+    void addModified(int delta, bool notify = true);
+    void resetModified();
+
+    /** 通知父属性、信号的连接者以及factory的监听者。*/
+    void emitValueChange();
+    void emitPropertyChange();
+    void emitAttributeChange(int atom);
+
+    QtPropertyUpdateBatch* batch_;
+    quint8              pending_;
+    QtPropertyWeakRef*  weakRef_;
+};
+
+/**
+ * @brief The QtPropertyPointer class
+ *
+ * Guarded pointer to a property, the counterpart of QPointer for the plain
+ * property nodes: it becomes NULL when the property is deleted. Only for use
+ * in the thread that owns the property tree.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyPointer
+{
+public:
+    QtPropertyPointer() : ref_(NULL) {}
+    QtPropertyPointer(QtProperty *property) : ref_(NULL) { reset(property); }
+    QtPropertyPointer(const QtPropertyPointer &other) : ref_(other.ref_) { if(ref_ != NULL) ++ref_->refCount; }
+    ~QtPropertyPointer(){ release(); }
+
+    QtPropertyPointer& operator=(const QtPropertyPointer &other)
+    {
+        if(other.ref_ != NULL)
+        {
+            ++other.ref_->refCount;
+        }
+        release();
+        ref_ = other.ref_;
+        return *this;
+    }
+
+    QtPropertyPointer& operator=(QtProperty *property)
+    {
+        reset(property);
+        return *this;
+    }
+
+    QtProperty* data() const { return ref_ != NULL ? ref_->property : NULL; }
+    bool isNull() const { return data() == NULL; }
+
+    operator QtProperty*() const { return data(); }
+    QtProperty* operator->() const { return data(); }
+
+private:
+    void reset(QtProperty *property)
+    {
+        QtPropertyWeakRef *ref = property != NULL ? property->getWeakRef() : NULL;
+        if(ref != NULL)
+        {
+            ++ref->refCount;
+        }
+        release();
+        ref_ = ref;
+    }
+
+    void release()
+    {
+        if(ref_ != NULL && --ref_->refCount == 0)
+        {
+            delete ref_;
+        }
+        ref_ = NULL;
+    }
+
+    QtPropertyWeakRef*  ref_;
+};
+
+template<typename LessThan>
+void QtProperty::sortChildren(LessThan lessThan)
+{
+    std::stable_sort(children_.begin(), children_.end(), lessThan);
+    childrenReordered(0, children_.size() - 1);
+}
+
+/** 在作用域内对属性进行批量更新。guard存在期间，property不可被delete。*/
+class QTPROPERTYSHEET_DLL QtPropertyUpdateGuard
+{
+public:
+    explicit QtPropertyUpdateGuard(QtProperty *property)
+        : property_(property)
+    {
+        property_->beginUpdate();
+    }
+
+    ~QtPropertyUpdateGuard()
+    {
+        property_->endUpdate();
+    }
+
+private:
+    Q_DISABLE_COPY(QtPropertyUpdateGuard)
+
+    QtProperty*     property_;
 };
 
 /********************************************************************/
 class QTPROPERTYSHEET_DLL QtContainerProperty : public QtProperty
 {
-    Q_OBJECT
 public:
     QtContainerProperty(Type type, QtPropertyFactory *factory);
 
-protected slots:
-    virtual void slotChildValueChange(QtProperty *property) = 0;
+    virtual const QVariant& getValue() const;
 
 protected:
-    virtual void onChildAdd(QtProperty *child);
-    virtual void onChildRemove(QtProperty *child);
+    virtual bool isDefaultValue() const { return true; }
+
+    /** 由子属性的值重新生成value_，在getValue时按需调用。*/
+    virtual void updateValue(){}
+
+    /** 为true时，正在把值分发给子属性，忽略子属性的值变化。*/
+    bool            settingValue_;
+    bool            valueDirty_;
 };
 
 
 /********************************************************************/
 class QTPROPERTYSHEET_DLL QtListProperty : public QtContainerProperty
 {
-    Q_OBJECT
 public:
     QtListProperty(Type type, QtPropertyFactory *factory);
 
     virtual void setValue(const QVariant &value);
     virtual QString getValueString() const;
 
-protected slots:
-    virtual void slotChildValueChange(QtProperty *property);
+protected:
+    virtual void copyFrom(const QtProperty *source);
+    virtual void onChildValueChange(QtProperty *child);
+    virtual void onChildrenReorder();
+    virtual void updateValue();
+
+    QVariantList    values_;
 };
 
 
 /********************************************************************/
 class QTPROPERTYSHEET_DLL QtDictProperty : public QtContainerProperty
 {
-    Q_OBJECT
 public:
     QtDictProperty(Type type, QtPropertyFactory *factory);
 
     virtual void setValue(const QVariant &value);
 
-protected slots:
-    virtual void slotChildValueChange(QtProperty *property);
+protected:
+    virtual void copyFrom(const QtProperty *source);
+    virtual void onChildValueChange(QtProperty *child);
+    virtual void updateValue();
+
+    QVariantMap     values_;
 };
 
 
@@ -169,7 +588,6 @@ protected slots:
  */
 class QTPROPERTYSHEET_DLL QtGroupProperty : public QtContainerProperty
 {
-    Q_OBJECT
 public:
     QtGroupProperty(Type type, QtPropertyFactory *factory);
 
@@ -179,8 +597,8 @@ public:
     virtual QtProperty* findChild(const QString &name);
     virtual void setChildValue(const QString &name, const QVariant &value);
 
-protected slots:
-    virtual void slotChildValueChange(QtProperty *property);
+protected:
+    virtual void onChildValueChange(QtProperty *child);
 };
 
 
@@ -188,7 +606,6 @@ protected slots:
 /********************************************************************/
 class QTPROPERTYSHEET_DLL QtEnumProperty : public QtProperty
 {
-    Q_OBJECT
 public:
     QtEnumProperty(Type type, QtPropertyFactory *factory);
     virtual QString getValueString() const;
@@ -197,7 +614,6 @@ public:
 /********************************************************************/
 class QTPROPERTYSHEET_DLL QtFlagProperty : public QtProperty
 {
-    Q_OBJECT
 public:
     QtFlagProperty(Type type, QtPropertyFactory *factory);
     virtual QString getValueString() const;
@@ -206,7 +622,6 @@ public:
 /********************************************************************/
 class QTPROPERTYSHEET_DLL QtBoolProperty : public QtProperty
 {
-    Q_OBJECT
 public:
     QtBoolProperty(Type type, QtPropertyFactory *factory);
     virtual QString getValueString() const;
@@ -216,7 +631,6 @@ public:
 /********************************************************************/
 class QTPROPERTYSHEET_DLL QtDoubleProperty : public QtProperty
 {
-    Q_OBJECT
 public:
     QtDoubleProperty(Type type, QtPropertyFactory *factory);
     virtual QString getValueString() const;
@@ -225,7 +639,6 @@ public:
 /********************************************************************/
 class QTPROPERTYSHEET_DLL QtColorProperty : public QtProperty
 {
-    Q_OBJECT
 public:
     QtColorProperty(Type type, QtPropertyFactory *factory);
 
@@ -235,71 +648,123 @@ public:
 /********************************************************************/
 class QTPROPERTYSHEET_DLL QtDynamicListProperty : public QtProperty
 {
-    Q_OBJECT
 public:
     QtDynamicListProperty(Type type, QtPropertyFactory *factory);
     ~QtDynamicListProperty();
 
     virtual void setValue(const QVariant &value);
     virtual QString getValueString() const;
+    virtual bool hasGeneratedChildren() const { return true; }
 
-protected slots:
-    void slotItemValueChange(QtProperty *item);
-    void slotItemMoveUp(QtProperty *item);
-    void slotItemMoveDown(QtProperty *item);
-    void slotItemDelete(QtProperty *item);
+    virtual void setAttribute(QtAttributeName::Atom atom, const QVariant &value);
+    using QtProperty::setAttribute;
 
-    void slotLengthChange(QtProperty *property);
+    void moveItemUp(QtProperty *item);
+    void moveItemDown(QtProperty *item);
+    void deleteItem(QtProperty *item);
 
-protected:
+    /** 改变元素个数。新元素从预先准备的原型复制，并一次插入到属性树中。*/
     void setLength(int length);
-    QtProperty* appendItem();
+    int getLength() const { return length_; }
+    QtProperty* getItem(int index) const { return items_.value(index); }
+
+protected:
+    virtual void copyFrom(const QtProperty *source);
+    virtual void onChildValueChange(QtProperty *child);
+    virtual void onChildrenReorder();
+
+    virtual void onDefinitionChange();
+
+    void onItemValueChange(QtProperty *item);
+    void onLengthChange(QtProperty *property);
+
+    /** 删除原型，下次使用时按新的属性重建。*/
+    void resetPrototype();
+
+    /** item在items_中的位置。*/
+    int itemIndex(QtProperty *item) const;
+
+    /** 按valueType、valueDefault和valueAttributes创建的原型元素，属性改变时重建。*/
+    QtDynamicItemProperty* getPrototype();
+    QtProperty* createItem();
     void popItem();
 
     int 			length_;
     QtProperty* 	propLength_;
     QtPropertyList  items_;
+    QtDynamicItemProperty* prototype_;
 
     QVariantList    valueList_;
 };
 
 class QTPROPERTYSHEET_DLL QtDynamicItemProperty : public QtProperty
 {
-    Q_OBJECT
 public:
     QtDynamicItemProperty(Type type, QtPropertyFactory *factory);
     ~QtDynamicItemProperty();
 
     void setValueType(Type type);
     QtProperty* getImpl(){ return impl_; }
+    const QtProperty* getImpl() const { return impl_; }
 
     virtual void setValue(const QVariant &value) override;
     virtual const QVariant& getValue() const override { return impl_->getValue(); }
 
+    virtual void setScalarValue(const QtPropertyValue &value) override { impl_->setScalarValue(value); }
+    virtual QtPropertyValue getScalarValue() const override { return impl_->getScalarValue(); }
+
     virtual QString getValueString() const override { return impl_->getValueString(); }
     virtual QIcon getValueIcon() const override{ return impl_->getValueIcon(); }
 
-signals:
-    void signalMoveUp(QtProperty *property);
-    void signalMoveDown(QtProperty *property);
-    void signalDelete(QtProperty *property);
-
-protected slots:
-    void onImplValueChange(QtProperty *property);
+    /** 请求所在的QtDynamicListProperty移动或删除本元素，并发出notifier的对应信号。*/
+    void moveUp();
+    void moveDown();
+    void remove();
 
 protected:
+    virtual void copyFrom(const QtProperty *source);
+    virtual void onChildValueChange(QtProperty *child);
+
     QtProperty*     impl_;
 };
 
 /********************************************************************/
 class QTPROPERTYSHEET_DLL QtFloatListProperty : public QtProperty
 {
-    Q_OBJECT
 public:
     QtFloatListProperty(Type type, QtPropertyFactory *factory);
     ~QtFloatListProperty();
 
+    /** 接受QVariantList或QVector<float>。*/
+    virtual void setValue(const QVariant &value);
+    /** 兼容接口，按需生成double的QVariantList。*/
+    virtual const QVariant& getValue() const;
     virtual QString getValueString() const;
+
+    /** 值连续保存在QVector<float>中，读写不经过QVariant。
+     *  传入的QVector被隐式共享，不会复制数据。
+     */
+    void setValues(const QVector<float> &values);
+    void setValues(const float *data, int count);
+    const QVector<float>& getValues() const { return values_; }
+
+    /** 修改一个分量。数据没有被共享时原地修改。*/
+    void setValueAt(int index, float value);
+
+protected:
+    virtual void copyFrom(const QtProperty *source);
+    virtual bool isDefaultValue() const;
+    virtual void onDefinitionChange();
+    virtual void onDefaultValueChange();
+
+    /** 从属性定义中读取默认值，并重新统计与默认值不同的分量。*/
+    void resetDefaults();
+    void countDifferences();
+    bool differsFromDefault(int index) const;
+
+    QVector<float>  values_;
+    QVector<float>  defaults_;
+    int             differCount_;   ///< 与默认值不同的分量数量，长度不同的部分也计入
 };
 
 #endif // QTPROPERTY_H
@@ -0,0 +1,132 @@
+﻿#include "qtpropertyarena.h"
+
+#include <cassert>
+#include <new>
+
+namespace
+{
+const size_t ArenaAlignment = 16;
+
+// empty blocks kept for the next tree, the rest go back to the heap.
+const int MaxSpareBlocks = 4;
+
+size_t alignSize(size_t size)
+{
+    return (size + ArenaAlignment - 1) & ~(ArenaAlignment - 1);
+}
+}
+
+QtPropertyArena::QtPropertyArena(size_t blockSize)
+    : blockSize_(alignSize(blockSize))
+    , current_(NULL)
+    , offset_(0)
+    , liveCount_(0)
+    , detached_(false)
+{
+
+}
+
+QtPropertyArena::~QtPropertyArena()
+{
+    assert(liveCount_ == 0);
+    foreach(Block *block, blocks_)
+    {
+        ::operator delete(block->data);
+        delete block;
+    }
+}
+
+void QtPropertyArena::detach()
+{
+    detached_ = true;
+    if(liveCount_ == 0)
+    {
+        delete this;
+    }
+}
+
+void* QtPropertyArena::allocate(size_t size)
+{
+    size = alignSize(size);
+    ++liveCount_;
+
+    // big objects don't fit the blocks well, give them a block of their own.
+    if(size > blockSize_ / 4)
+    {
+        Block *block = newBlock(size);
+        ++block->liveCount;
+        return block->data;
+    }
+
+    if(current_ == NULL || offset_ + size > current_->size)
+    {
+        if(current_ != NULL && current_->liveCount == 0)
+        {
+            spareBlocks_.push_back(current_);
+        }
+        if(!spareBlocks_.isEmpty())
+        {
+            current_ = spareBlocks_.back();
+            spareBlocks_.pop_back();
+        }
+        else
+        {
+            current_ = newBlock(blockSize_);
+        }
+        offset_ = 0;
+    }
+
+    char *p = current_->data + offset_;
+    offset_ += size;
+    ++current_->liveCount;
+    return p;
+}
+
+void QtPropertyArena::release(void *p)
+{
+    assert(liveCount_ > 0);
+
+    // the block starting at or before p holds it.
+    QMap<quintptr, Block*>::iterator it = blocks_.upperBound(reinterpret_cast<quintptr>(p));
+    assert(it != blocks_.begin());
+    Block *block = (--it).value();
+
+    assert(block->liveCount > 0);
+    if(--block->liveCount == 0)
+    {
+        if(block == current_)
+        {
+            offset_ = 0;
+        }
+        else if(block->size == blockSize_ && spareBlocks_.size() < MaxSpareBlocks)
+        {
+            spareBlocks_.push_back(block);
+        }
+        else
+        {
+            freeBlock(block);
+        }
+    }
+
+    if(--liveCount_ == 0 && detached_)
+    {
+        delete this;
+    }
+}
+
+QtPropertyArena::Block* QtPropertyArena::newBlock(size_t size)
+{
+    Block *block = new Block;
+    block->data = static_cast<char*>(::operator new(size));
+    block->size = size;
+    block->liveCount = 0;
+    blocks_.insert(reinterpret_cast<quintptr>(block->data), block);
+    return block;
+}
+
+void QtPropertyArena::freeBlock(Block *block)
+{
+    blocks_.remove(reinterpret_cast<quintptr>(block->data));
+    ::operator delete(block->data);
+    delete block;
+}
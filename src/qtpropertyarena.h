@@ -0,0 +1,63 @@
+﻿#ifndef QTPROPERTYARENA_H
+#define QTPROPERTYARENA_H
+
+#include "qtpropertyconfig.h"
+#include <QVector>
+#include <QMap>
+#include <cstddef>
+
+/**
+ * @brief The QtPropertyArena class
+ *
+ * Bump allocator for the properties of a factory. Nodes created one after
+ * another sit next to each other in large blocks. Every block counts the nodes
+ * still living in it; a block whose nodes are all deleted is rewound and
+ * reused, or returned to the heap when enough empty blocks are kept already,
+ * so one long lived tree only pins the blocks it actually occupies.
+ *
+ * The arena is owned by its factory until the factory is deleted, and by the
+ * nodes left in it afterwards: detach() hands it over, and the arena deletes
+ * itself when the last of those nodes goes away.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyArena
+{
+public:
+    explicit QtPropertyArena(size_t blockSize = 64 * 1024);
+
+    void* allocate(size_t size);
+
+    /** 释放一次分配。内存块中的分配都释放后，内存块被重用或还给堆。*/
+    void release(void *p);
+
+    /** 创建者不再使用arena。没有存活的分配时立即delete，否则在最后一次release时delete。*/
+    void detach();
+
+    int getLiveCount() const { return liveCount_; }
+
+private:
+    Q_DISABLE_COPY(QtPropertyArena)
+
+    /** 只能通过detach释放。*/
+    ~QtPropertyArena();
+
+    struct Block
+    {
+        char*   data;
+        size_t  size;
+        int     liveCount;
+    };
+
+    Block* newBlock(size_t size);
+    void freeBlock(Block *block);
+
+    size_t                  blockSize_;
+    /** 以起始地址为key，release时据此找到分配所在的块。*/
+    QMap<quintptr, Block*>  blocks_;
+    QVector<Block*>         spareBlocks_;
+    Block*                  current_;
+    size_t                  offset_;
+    int                     liveCount_;
+    bool                    detached_;
+};
+
+#endif // QTPROPERTYARENA_H
@@ -0,0 +1,73 @@
+﻿#include "qtpropertyattributes.h"
+
+int QtPropertyAttributes::lowerBound(QtAttributeName::Atom atom) const
+{
+    int low = 0;
+    int high = entries_.size();
+    while(low < high)
+    {
+        int mid = (low + high) / 2;
+        if(entries_[mid].atom < atom)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+const QVariant* QtPropertyAttributes::find(QtAttributeName::Atom atom) const
+{
+    int i = lowerBound(atom);
+    if(i < entries_.size() && entries_[i].atom == atom)
+    {
+        return &entries_[i].value;
+    }
+    return NULL;
+}
+
+QVariant QtPropertyAttributes::value(QtAttributeName::Atom atom) const
+{
+    const QVariant *v = find(atom);
+    return v != NULL ? *v : QVariant();
+}
+
+void QtPropertyAttributes::insert(QtAttributeName::Atom atom, const QVariant &value)
+{
+    int i = lowerBound(atom);
+    if(i < entries_.size() && entries_[i].atom == atom)
+    {
+        entries_[i].value = value;
+    }
+    else
+    {
+        Entry entry;
+        entry.atom = atom;
+        entry.value = value;
+        entries_.insert(i, entry);
+    }
+}
+
+bool QtPropertyAttributes::remove(QtAttributeName::Atom atom)
+{
+    int i = lowerBound(atom);
+    if(i < entries_.size() && entries_[i].atom == atom)
+    {
+        entries_.remove(i);
+        return true;
+    }
+    return false;
+}
+
+QVariantMap QtPropertyAttributes::toMap() const
+{
+    QVariantMap map;
+    foreach(const Entry &entry, entries_)
+    {
+        map.insert(QtAttributeName::atomName(entry.atom), entry.value);
+    }
+    return map;
+}
@@ -0,0 +1,50 @@
+﻿#ifndef QTPROPERTYATTRIBUTES_H
+#define QTPROPERTYATTRIBUTES_H
+
+#include "qtpropertyconfig.h"
+#include "qtattributename.h"
+#include <QVector>
+#include <QVariant>
+
+/**
+ * @brief The QtPropertyAttributes class
+ *
+ * Attributes of a property, stored as a small array sorted by attribute atom.
+ * Lookups are a binary search over a few integers, and a property without
+ * attributes costs only a pointer to the shared empty array.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyAttributes
+{
+public:
+    struct Entry
+    {
+        QtAttributeName::Atom   atom;
+        QVariant                value;
+    };
+    typedef QVector<Entry>::const_iterator const_iterator;
+
+    /** 返回属性值的指针，不存在则返回NULL。*/
+    const QVariant* find(QtAttributeName::Atom atom) const;
+    QVariant value(QtAttributeName::Atom atom) const;
+    bool contains(QtAttributeName::Atom atom) const { return find(atom) != NULL; }
+
+    void insert(QtAttributeName::Atom atom, const QVariant &value);
+    bool remove(QtAttributeName::Atom atom);
+    void clear(){ entries_.clear(); }
+
+    int size() const { return entries_.size(); }
+    bool isEmpty() const { return entries_.isEmpty(); }
+
+    const_iterator begin() const { return entries_.constBegin(); }
+    const_iterator end() const { return entries_.constEnd(); }
+
+    /** 转换成以名称为key的QVariantMap。*/
+    QVariantMap toMap() const;
+
+private:
+    int lowerBound(QtAttributeName::Atom atom) const;
+
+    QVector<Entry>  entries_;
+};
+
+#endif // QTPROPERTYATTRIBUTES_H
@@ -1,12 +1,74 @@
 ﻿#include "qtpropertybrowser.h"
+#include "qtproperty.h"
 
 QtPropertyBrowser::QtPropertyBrowser(QObject *parent)
     : QObject(parent)
+    , lazyCacheSize_(-1)
 {
 
 }
 
 QtPropertyBrowser::~QtPropertyBrowser()
 {
+    foreach(QtPropertyFactory *factory, factories_)
+    {
+        if(factory != NULL)
+        {
+            factory->removeListener(this);
+        }
+    }
+}
+
+void QtPropertyBrowser::listenTo(QtProperty *property)
+{
+    QtPropertyFactory *factory = property->getFactory();
+    if(factory != NULL && !factories_.contains(factory))
+    {
+        factories_.push_back(factory);
+        factory->addListener(this);
+    }
+}
+
+void QtPropertyBrowser::setLazyCacheSize(int size)
+{
+    lazyCacheSize_ = size;
+    trimLazyCache();
+}
+
+void QtPropertyBrowser::lazyExpanded(QtProperty *property)
+{
+    if(property->getChildProvider() != NULL)
+    {
+        collapsed_.removeAll(property);
+        property->populate();
+    }
+}
+
+void QtPropertyBrowser::lazyCollapsed(QtProperty *property)
+{
+    if(property->getChildProvider() != NULL && property->isPopulated() && lazyCacheSize_ >= 0)
+    {
+        collapsed_.removeAll(property);
+        collapsed_.push_back(property);
+        trimLazyCache();
+    }
+}
+
+void QtPropertyBrowser::trimLazyCache()
+{
+    if(lazyCacheSize_ < 0)
+    {
+        collapsed_.clear();
+        return;
+    }
 
+    while(collapsed_.size() > lazyCacheSize_)
+    {
+        // releasing an ancestor may have deleted it already.
+        QtProperty *property = collapsed_.takeFirst();
+        if(property != NULL && !isExpanded(property))
+        {
+            property->releaseChildren();
+        }
+    }
 }
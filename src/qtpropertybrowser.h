@@ -2,14 +2,17 @@
 #define QT_PROPERTY_BROWSER_H
 
 #include "qtpropertyconfig.h"
+#include "qtpropertyfactory.h"
+#include "qtproperty.h"
 #include <QObject>
+#include <QPointer>
+#include <QList>
 
 class QWidget;
-class QtProperty;
 class QtPropertyEditorFactory;
 
 
-class QTPROPERTYSHEET_DLL QtPropertyBrowser : public QObject
+class QTPROPERTYSHEET_DLL QtPropertyBrowser : public QObject, public QtPropertyListener
 {
     Q_OBJECT
 public:
@@ -24,6 +27,32 @@ public:
 
     virtual bool isExpanded(QtProperty *property) = 0;
     virtual void setExpanded(QtProperty *property, bool expand) = 0;
+
+    /** 展开的属性的子属性正在显示。*/
+    virtual bool isChildrenInUse(QtProperty *property){ return isExpanded(property); }
+
+    /** 折叠后仍保留子属性的懒加载属性数量，超出时释放最早折叠的。
+     *  -1表示从不释放，为默认值；0表示折叠时立即释放。
+     */
+    void setLazyCacheSize(int size);
+    int getLazyCacheSize() const { return lazyCacheSize_; }
+
+protected:
+    /** 注册为property所属factory的监听者，每个factory只注册一次。*/
+    void listenTo(QtProperty *property);
+
+    /** 懒加载属性被展开时创建子属性，折叠时按lazyCacheSize释放。*/
+    void lazyExpanded(QtProperty *property);
+    void lazyCollapsed(QtProperty *property);
+
+private:
+    void trimLazyCache();
+
+    QList< QPointer<QtPropertyFactory> > factories_;
+
+    /** 已折叠但未释放的懒加载属性，最早折叠的在前面。*/
+    QList<QtPropertyPointer>    collapsed_;
+    int                         lazyCacheSize_;
 };
 
 #endif // QT_PROPERTY_BROWSER_H
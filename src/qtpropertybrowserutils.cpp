@@ -283,6 +283,10 @@ QColor QtPropertyBrowserUtils::variant2color(const QVariant &value)
     {
         return value.value<QColor>();
     }
+    else if(value.type() == QVariant::String)
+    {
+        return QColor(value.toString());
+    }
     else if(value.type() == QVariant::List)
     {
         QVariantList val = value.toList();
@@ -0,0 +1,167 @@
+﻿#include "qtpropertydefinition.h"
+
+class QtPropertyDefinitionData : public QSharedData
+{
+public:
+    QtPropertyDefinitionData()
+        : type(QtPropertyType::NONE)
+    {}
+
+    QtPropertyType::Type    type;
+    QString                 name;
+    QString                 title;
+    QString                 tips;
+    QColor                  bgColor;
+    QtPropertyAttributes    attributes;
+    QVariant                defaultValue;
+    QtPropertyDefinition::DefinitionList children;
+};
+
+static const QSharedDataPointer<QtPropertyDefinitionData>& sharedNull()
+{
+    static QSharedDataPointer<QtPropertyDefinitionData> null(new QtPropertyDefinitionData());
+    return null;
+}
+
+QtPropertyDefinition::QtPropertyDefinition()
+    : d(sharedNull())
+{
+
+}
+
+QtPropertyDefinition::QtPropertyDefinition(QtPropertyType::Type type, const QString &name)
+    : d(new QtPropertyDefinitionData())
+{
+    d->type = type;
+    d->name = name;
+}
+
+QtPropertyDefinition::QtPropertyDefinition(const QtPropertyDefinition &other)
+    : d(other.d)
+{
+
+}
+
+QtPropertyDefinition& QtPropertyDefinition::operator=(const QtPropertyDefinition &other)
+{
+    d = other.d;
+    return *this;
+}
+
+QtPropertyDefinition::~QtPropertyDefinition()
+{
+
+}
+
+QtPropertyType::Type QtPropertyDefinition::getType() const
+{
+    return d->type;
+}
+
+void QtPropertyDefinition::setType(QtPropertyType::Type type)
+{
+    if(d.constData()->type != type)
+    {
+        d->type = type;
+    }
+}
+
+const QString& QtPropertyDefinition::getName() const
+{
+    return d->name;
+}
+
+void QtPropertyDefinition::setName(const QString &name)
+{
+    if(d.constData()->name != name)
+    {
+        d->name = name;
+    }
+}
+
+const QString& QtPropertyDefinition::getTitle() const
+{
+    return d->title;
+}
+
+void QtPropertyDefinition::setTitle(const QString &title)
+{
+    if(d.constData()->title != title)
+    {
+        d->title = title;
+    }
+}
+
+const QString& QtPropertyDefinition::getToolTip() const
+{
+    return d->tips;
+}
+
+void QtPropertyDefinition::setToolTip(const QString &tip)
+{
+    if(d.constData()->tips != tip)
+    {
+        d->tips = tip;
+    }
+}
+
+const QColor& QtPropertyDefinition::getBackgroundColor() const
+{
+    return d->bgColor;
+}
+
+void QtPropertyDefinition::setBackgroundColor(const QColor &cr)
+{
+    if(d.constData()->bgColor != cr)
+    {
+        d->bgColor = cr;
+    }
+}
+
+const QtPropertyAttributes& QtPropertyDefinition::getAttributes() const
+{
+    return d->attributes;
+}
+
+QVariant QtPropertyDefinition::getAttribute(QtAttributeName::Atom atom) const
+{
+    return d->attributes.value(atom);
+}
+
+void QtPropertyDefinition::setAttribute(QtAttributeName::Atom atom, const QVariant &value)
+{
+    // compare on the shared data first, so an unchanged value never detaches.
+    const QVariant *old = d.constData()->attributes.find(atom);
+    if(old == NULL || *old != value)
+    {
+        d->attributes.insert(atom, value);
+    }
+}
+
+void QtPropertyDefinition::setAttribute(const QString &name, const QVariant &value)
+{
+    setAttribute(QtAttributeName::registerAtom(name), value);
+}
+
+const QVariant& QtPropertyDefinition::getDefaultValue() const
+{
+    return d->defaultValue;
+}
+
+void QtPropertyDefinition::setDefaultValue(const QVariant &value)
+{
+    if(d.constData()->defaultValue != value)
+    {
+        d->defaultValue = value;
+    }
+}
+
+const QtPropertyDefinition::DefinitionList& QtPropertyDefinition::getChildren() const
+{
+    return d->children;
+}
+
+void QtPropertyDefinition::addChild(const QtPropertyDefinition &child)
+{
+    d->children.push_back(child);
+}
@@ -0,0 +1,74 @@
+﻿#ifndef QTPROPERTYDEFINITION_H
+#define QTPROPERTYDEFINITION_H
+
+#include "qtpropertyconfig.h"
+#include "qtpropertytype.h"
+#include "qtpropertyattributes.h"
+#include <QSharedDataPointer>
+#include <QVector>
+#include <QVariant>
+#include <QColor>
+
+class QtPropertyDefinitionData;
+
+/**
+ * @brief The QtPropertyDefinition class
+ *
+ * Describes everything a property has except its value: type, name, title,
+ * tool tip, background color, attributes, default value and child definitions.
+ *
+ * A definition is implicitly shared. Many QtProperty instances created from the
+ * same definition share one copy of the descriptive data; calling a setter on a
+ * property detaches only that property, so per-instance overrides cost nothing
+ * for the instances that don't use them.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyDefinition
+{
+public:
+    typedef QVector<QtPropertyDefinition> DefinitionList;
+
+    /** 构造空定义，所有空定义共享同一份数据。*/
+    QtPropertyDefinition();
+    explicit QtPropertyDefinition(QtPropertyType::Type type, const QString &name = QString());
+    QtPropertyDefinition(const QtPropertyDefinition &other);
+    QtPropertyDefinition& operator=(const QtPropertyDefinition &other);
+    ~QtPropertyDefinition();
+
+    QtPropertyType::Type getType() const;
+    void setType(QtPropertyType::Type type);
+
+    const QString& getName() const;
+    void setName(const QString &name);
+
+    const QString& getTitle() const;
+    void setTitle(const QString &title);
+
+    const QString& getToolTip() const;
+    void setToolTip(const QString &tip);
+
+    const QColor& getBackgroundColor() const;
+    void setBackgroundColor(const QColor &cr);
+
+    const QtPropertyAttributes& getAttributes() const;
+    QVariant getAttribute(QtAttributeName::Atom atom) const;
+    void setAttribute(QtAttributeName::Atom atom, const QVariant &value);
+    void setAttribute(const QString &name, const QVariant &value);
+
+    /** 由定义创建属性时设置的初始值。*/
+    const QVariant& getDefaultValue() const;
+    void setDefaultValue(const QVariant &value);
+
+    const DefinitionList& getChildren() const;
+    void addChild(const QtPropertyDefinition &child);
+
+    /** 两个定义是否引用同一份共享数据。*/
+    bool isSharedWith(const QtPropertyDefinition &other) const { return d == other.d; }
+
+    /** 共享数据的地址，可以作为key识别共享同一份数据的定义。*/
+    const void* getSharedKey() const { return d.constData(); }
+
+private:
+    QSharedDataPointer<QtPropertyDefinitionData> d;
+};
+
+#endif // QTPROPERTYDEFINITION_H
@@ -0,0 +1,313 @@
+﻿#include "qtpropertydelta.h"
+#include "qtproperty.h"
+
+#include <QHash>
+#include <algorithm>
+
+QtValueEntry QtValueEntry::capture(const QtProperty *property, const QString &path)
+{
+    QtValueEntry entry;
+    entry.path = path;
+
+    const QtFloatListProperty *floatList = dynamic_cast<const QtFloatListProperty*>(property);
+    if(floatList != NULL)
+    {
+        entry.floats = floatList->getValues();
+        entry.isFloats = true;
+    }
+    else
+    {
+        entry.value = property->getScalarValue();
+    }
+    return entry;
+}
+
+QtValueEntry QtValueEntry::captureComponent(const QtProperty *property, int component, const QString &path)
+{
+    const QtFloatListProperty *floatList = dynamic_cast<const QtFloatListProperty*>(property);
+    if(floatList == NULL || component < 0 || component >= floatList->getValues().size())
+    {
+        return capture(property, path);
+    }
+
+    QtValueEntry entry;
+    entry.path = path;
+    entry.floats.push_back(floatList->getValues().at(component));
+    entry.components.push_back(component);
+    entry.isFloats = true;
+    return entry;
+}
+
+void QtValueEntry::assignTo(QtProperty *property) const
+{
+    if(isFloats)
+    {
+        QtFloatListProperty *floatList = dynamic_cast<QtFloatListProperty*>(property);
+        if(floatList == NULL)
+        {
+            return;
+        }
+
+        if(isPartial())
+        {
+            for(int i = 0; i < components.size(); ++i)
+            {
+                floatList->setValueAt(components[i], floats[i]);
+            }
+        }
+        else
+        {
+            floatList->setValues(floats);
+        }
+    }
+    else if(value.getKind() == QtPropertyValue::VARIANT)
+    {
+        property->setValue(value.toVariant());
+    }
+    else
+    {
+        property->setScalarValue(value);
+    }
+}
+
+bool QtValueEntry::sameValue(const QtValueEntry &other) const
+{
+    if(isFloats != other.isFloats)
+    {
+        return false;
+    }
+    if(isFloats)
+    {
+        return components == other.components && floats == other.floats;
+    }
+    return value == other.value;
+}
+
+void QtValueEntry::merge(const QtValueEntry &other, bool replace)
+{
+    if(!other.isPartial())
+    {
+        if(replace)
+        {
+            *this = other;
+        }
+        else if(isPartial() && other.isFloats)
+        {
+            // the components recorded here are older than the whole value.
+            QtValueEntry whole = other;
+            for(int i = 0; i < components.size(); ++i)
+            {
+                if(components[i] < whole.floats.size())
+                {
+                    whole.floats[components[i]] = floats[i];
+                }
+            }
+            *this = whole;
+        }
+        return;
+    }
+
+    if(!isFloats)
+    {
+        if(replace)
+        {
+            *this = other;
+        }
+        return;
+    }
+
+    for(int i = 0; i < other.components.size(); ++i)
+    {
+        int component = other.components[i];
+        if(!isPartial())
+        {
+            if(replace && component < floats.size())
+            {
+                floats[component] = other.floats[i];
+            }
+            continue;
+        }
+
+        int pos = components.indexOf(component);
+        if(pos < 0)
+        {
+            components.push_back(component);
+            floats.push_back(other.floats[i]);
+        }
+        else if(replace)
+        {
+            floats[pos] = other.floats[i];
+        }
+    }
+}
+
+QtValueSnapshot QtValueSnapshot::capture(const QtProperty *root)
+{
+    QtValueSnapshot snapshot;
+    snapshot.captureNode(root, QString());
+    return snapshot;
+}
+
+void QtValueSnapshot::captureNode(const QtProperty *property, const QString &path)
+{
+    const QtPropertyList &children = property->getChildren();
+    if(children.isEmpty())
+    {
+        if(!property->hasValue())
+        {
+            return;
+        }
+
+        entries_.push_back(QtValueEntry::capture(property, path));
+        return;
+    }
+
+    QString prefix = path.isEmpty() ? path : path + '/';
+    foreach(const QtProperty *child, children)
+    {
+        captureNode(child, prefix + child->getName());
+    }
+}
+
+/********************************************************************/
+QtPropertyDelta QtPropertyDelta::diff(const QtValueSnapshot &from, const QtValueSnapshot &to)
+{
+    QtPropertyDelta delta;
+
+    const QVector<QtValueEntry> &oldEntries = from.getEntries();
+    const QVector<QtValueEntry> &newEntries = to.getEntries();
+
+    // the common case is the same tree with some values changed.
+    int first = 0;
+    int count = std::min(oldEntries.size(), newEntries.size());
+    while(first < count && oldEntries[first].path == newEntries[first].path)
+    {
+        if(!oldEntries[first].sameValue(newEntries[first]))
+        {
+            delta.values_.push_back(newEntries[first]);
+            delta.added_.push_back(false);
+        }
+        ++first;
+    }
+
+    if(first == oldEntries.size() && first == newEntries.size())
+    {
+        return delta;
+    }
+
+    QHash<QString, int> oldIndex;
+    oldIndex.reserve(oldEntries.size() - first);
+    for(int i = first; i < oldEntries.size(); ++i)
+    {
+        oldIndex.insert(oldEntries[i].path, i);
+    }
+
+    for(int i = first; i < newEntries.size(); ++i)
+    {
+        const QtValueEntry &entry = newEntries[i];
+        QHash<QString, int>::iterator it = oldIndex.find(entry.path);
+        if(it == oldIndex.end())
+        {
+            delta.values_.push_back(entry);
+            delta.added_.push_back(true);
+            continue;
+        }
+
+        if(!oldEntries[*it].sameValue(entry))
+        {
+            delta.values_.push_back(entry);
+            delta.added_.push_back(false);
+        }
+        oldIndex.erase(it);
+    }
+
+    // what is left was removed, keep the order of the old snapshot.
+    for(int i = first; i < oldEntries.size() && !oldIndex.isEmpty(); ++i)
+    {
+        if(oldIndex.remove(oldEntries[i].path) > 0)
+        {
+            delta.removed_.push_back(oldEntries[i].path);
+        }
+    }
+    return delta;
+}
+
+void QtPropertyDelta::setValue(const QtValueEntry &entry, bool replace)
+{
+    // paths are unique, so the index is complete when the sizes match.
+    if(index_.size() != values_.size())
+    {
+        index_.clear();
+        index_.reserve(values_.size());
+        for(int i = 0; i < values_.size(); ++i)
+        {
+            index_.insert(values_[i].path, i);
+        }
+    }
+
+    QHash<QString, int>::const_iterator it = index_.constFind(entry.path);
+    if(it != index_.constEnd())
+    {
+        values_[*it].merge(entry, replace);
+        return;
+    }
+
+    index_.insert(entry.path, values_.size());
+    values_.push_back(entry);
+    added_.push_back(false);
+}
+
+QStringList QtPropertyDelta::getChanged() const
+{
+    QStringList paths;
+    for(int i = 0; i < values_.size(); ++i)
+    {
+        if(!added_[i])
+        {
+            paths.push_back(values_[i].path);
+        }
+    }
+    return paths;
+}
+
+QStringList QtPropertyDelta::getAdded() const
+{
+    QStringList paths;
+    for(int i = 0; i < values_.size(); ++i)
+    {
+        if(added_[i])
+        {
+            paths.push_back(values_[i].path);
+        }
+    }
+    return paths;
+}
+
+void QtPropertyDelta::apply(QtProperty *root) const
+{
+    QtPropertyUpdateGuard guard(root);
+
+    foreach(const QtValueEntry &entry, values_)
+    {
+        QtProperty *property = root->findByPath(entry.path);
+        if(property != NULL)
+        {
+            entry.assignTo(property);
+        }
+    }
+
+    foreach(const QString &path, removed_)
+    {
+        QtProperty *property = root->findByPath(path);
+        if(property == NULL || property == root)
+        {
+            continue;
+        }
+
+        QtProperty *parent = property->getParent();
+        if(parent != NULL && !parent->hasGeneratedChildren())
+        {
+            property->destroy();
+        }
+    }
+}
@@ -0,0 +1,106 @@
+﻿#ifndef QTPROPERTYDELTA_H
+#define QTPROPERTYDELTA_H
+
+#include "qtpropertyconfig.h"
+#include "qtpropertyvalue.h"
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+
+class QtProperty;
+
+/** 快照中一个属性的值。float list的值保存在floats中，不转换为QVariant。
+ *  components不为空时只记录了部分分量，floats[i]是第components[i]个分量的值。
+ */
+struct QtValueEntry
+{
+    QString             path;   ///< 相对于快照根的路径，以'/'分隔
+    QtPropertyValue     value;
+    QVector<float>      floats;
+    QVector<int>        components;
+    bool                isFloats;
+
+    QtValueEntry() : isFloats(false) {}
+
+    /** 读取property当前的值。*/
+    static QtValueEntry capture(const QtProperty *property, const QString &path);
+
+    /** 只读取float list的一个分量。property不是float list时读取整个值。*/
+    static QtValueEntry captureComponent(const QtProperty *property, int component, const QString &path);
+
+    bool isPartial() const { return !components.isEmpty(); }
+
+    /** 把值写入property，不检查路径。*/
+    void assignTo(QtProperty *property) const;
+
+    bool sameValue(const QtValueEntry &other) const;
+
+    /** 合并同一路径的另一个值。replace为true时other较新，否则较旧。*/
+    void merge(const QtValueEntry &other, bool replace);
+};
+
+/**
+ * @brief The QtValueSnapshot class
+ *
+ * The values of all leaf properties of a subtree, in pre-order. Containers
+ * are not recorded since their values are made of their children. A dynamic
+ * list is recorded through its "length" child and its items, so a length
+ * change is always applied before the values of new items.
+ */
+class QTPROPERTYSHEET_DLL QtValueSnapshot
+{
+public:
+    static QtValueSnapshot capture(const QtProperty *root);
+
+    const QVector<QtValueEntry>& getEntries() const { return entries_; }
+    int size() const { return entries_.size(); }
+
+private:
+    void captureNode(const QtProperty *property, const QString &path);
+
+    QVector<QtValueEntry> entries_;
+};
+
+/**
+ * @brief The QtPropertyDelta class
+ *
+ * The difference between two value snapshots: paths whose value changed,
+ * paths that only exist in the new snapshot, and paths that only exist in
+ * the old one. apply() touches only these paths, inside one batch update.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyDelta
+{
+public:
+    /** 计算from到to的差异。两个快照结构相同的部分按位置比较，不需要查表。*/
+    static QtPropertyDelta diff(const QtValueSnapshot &from, const QtValueSnapshot &to);
+
+    bool isEmpty() const { return values_.isEmpty() && removed_.isEmpty(); }
+
+    /** 设置一个路径的值，作为修改记录。路径已经存在时，replace为true则替换，否则保留原来的值。
+     *  只记录部分分量的值按分量合并。
+     */
+    void setValue(const QtValueEntry &entry, bool replace = true);
+
+    /** 修改和新增的值，按to中的前序排列。*/
+    const QVector<QtValueEntry>& getValues() const { return values_; }
+    QStringList getChanged() const;
+    QStringList getAdded() const;
+    const QStringList& getRemoved() const { return removed_; }
+
+    /** 把差异应用到root，只发出一次批量通知。
+     *  找不到路径的值被忽略。被移除的属性如果仍然存在，并且不是由父属性生成的，
+     *  会从属性树中删除；dynamic list的元素随length的变化增减。
+     */
+    void apply(QtProperty *root) const;
+
+private:
+    QVector<QtValueEntry>   values_;
+    QVector<bool>           added_;
+    QStringList             removed_;
+
+    // path -> position in values_, built on the first setValue.
+    QHash<QString, int>     index_;
+};
+
+#endif // QTPROPERTYDELTA_H
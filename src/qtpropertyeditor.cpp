@@ -4,6 +4,7 @@
 #include "qxtcheckcombobox.h"
 #include "qtattributename.h"
 #include "qtpropertyeditorfactory.h"
+#include "qtpropertyundo.h"
 
 #include <QSpinBox>
 #include <QDoubleSpinBox>
@@ -23,15 +24,16 @@
 QtPropertyEditor::QtPropertyEditor(QtProperty *property)
     : property_(property)
 {
-    connect(property, SIGNAL(signalValueChange(QtProperty*)), this, SLOT(onPropertyValueChange(QtProperty*)));
-    connect(property, SIGNAL(destroyed(QObject*)), this, SLOT(onPropertyDestory(QObject*)));
+    QtPropertyNotifier *notifier = property->getNotifier();
+    connect(notifier, SIGNAL(signalValueChange(QtProperty*)), this, SLOT(onPropertyValueChange(QtProperty*)));
+    connect(notifier, SIGNAL(signalDestroyed(QtProperty*)), this, SLOT(onPropertyDestory(QtProperty*)));
 }
 
 QtPropertyEditor::~QtPropertyEditor()
 {
 }
 
-void QtPropertyEditor::onPropertyDestory(QObject * /*object*/)
+void QtPropertyEditor::onPropertyDestory(QtProperty * /*property*/)
 {
     property_ = NULL;
     delete this;
@@ -47,8 +49,8 @@ QtIntSpinBoxEditor::QtIntSpinBoxEditor(QtProperty *property)
     : QtPropertyEditor(property)
     , editor_(0)
 {
-    value_ = property_->getValue().toInt();
-    connect(property, SIGNAL(signalAttributeChange(QtProperty*,QString)), this, SLOT(slotSetAttribute(QtProperty*,QString)));
+    value_ = property_->getIntValue();
+    connect(property->getNotifier(), SIGNAL(signalAttributeChange(QtProperty*,int)), this, SLOT(slotSetAttribute(QtProperty*,int)));
 }
 
 QWidget* QtIntSpinBoxEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /*factory*/)
@@ -58,9 +60,9 @@ QWidget* QtIntSpinBoxEditor::createEditor(QWidget *parent, QtPropertyEditorFacto
         editor_ = new QSpinBox(parent);
         editor_->setKeyboardTracking(false);
 
-        slotSetAttribute(property_, QtAttributeName::MinValue);
-        slotSetAttribute(property_, QtAttributeName::MaxValue);
-        slotSetAttribute(property_, QtAttributeName::ReadOnly);
+        slotSetAttribute(property_, QtAttributeName::MIN_VALUE);
+        slotSetAttribute(property_, QtAttributeName::MAX_VALUE);
+        slotSetAttribute(property_, QtAttributeName::READ_ONLY);
 
         editor_->setValue(value_);
 
@@ -79,13 +81,14 @@ void QtIntSpinBoxEditor::slotEditorValueChange(int value)
 
     if(property_ != 0)
     {
-        property_->setValue(value);
+        QtPropertyUndoRecorder recorder(property_);
+        property_->setIntValue(value);
     }
 }
 
 void QtIntSpinBoxEditor::onPropertyValueChange(QtProperty* property)
 {
-    value_ = property->getValue().toInt();
+    value_ = property->getIntValue();
     if(editor_ != 0)
     {
         editor_->blockSignals(true);
@@ -94,25 +97,25 @@ void QtIntSpinBoxEditor::onPropertyValueChange(QtProperty* property)
     }
 }
 
-void QtIntSpinBoxEditor::slotSetAttribute(QtProperty *property, const QString &name)
+void QtIntSpinBoxEditor::slotSetAttribute(QtProperty *property, int atom)
 {
     if(NULL == editor_)
     {
         return;
     }
 
-    QVariant v = property->getAttribute(name);
-    if(name == QtAttributeName::MinValue)
+    QVariant v = property->getAttribute(atom);
+    if(atom == QtAttributeName::MIN_VALUE)
     {
         int minValue = (v.type() == QVariant::Int) ? v.toInt() : std::numeric_limits<int>::min();
         editor_->setMinimum(minValue);
     }
-    else if(name == QtAttributeName::MaxValue)
+    else if(atom == QtAttributeName::MAX_VALUE)
     {
         int maxValue = (v.type() == QVariant::Int) ? v.toInt() : std::numeric_limits<int>::max();
         editor_->setMaximum(maxValue);
     }
-    else if(name == QtAttributeName::ReadOnly)
+    else if(atom == QtAttributeName::READ_ONLY)
     {
         editor_->setReadOnly(v.type() == QVariant::Bool && v.toBool());
     }
@@ -123,8 +126,8 @@ QtDoubleSpinBoxEditor::QtDoubleSpinBoxEditor(QtProperty *property)
     : QtPropertyEditor(property)
     , editor_(0)
 {
-    value_ = property_->getValue().toDouble();
-    connect(property_, SIGNAL(signalAttributeChange(QtProperty*,QString)), this, SLOT(slotSetAttribute(QtProperty*,QString)));
+    value_ = property_->getDoubleValue();
+    connect(property_->getNotifier(), SIGNAL(signalAttributeChange(QtProperty*,int)), this, SLOT(slotSetAttribute(QtProperty*,int)));
 }
 
 QWidget* QtDoubleSpinBoxEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /*factory*/)
@@ -134,10 +137,10 @@ QWidget* QtDoubleSpinBoxEditor::createEditor(QWidget *parent, QtPropertyEditorFa
         editor_ = new QDoubleSpinBox(parent);
         editor_->setKeyboardTracking(false);
 
-        slotSetAttribute(property_, QtAttributeName::MinValue);
-        slotSetAttribute(property_, QtAttributeName::MaxValue);
-        slotSetAttribute(property_, QtAttributeName::Decimals);
-        slotSetAttribute(property_, QtAttributeName::ReadOnly);
+        slotSetAttribute(property_, QtAttributeName::MIN_VALUE);
+        slotSetAttribute(property_, QtAttributeName::MAX_VALUE);
+        slotSetAttribute(property_, QtAttributeName::DECIMALS);
+        slotSetAttribute(property_, QtAttributeName::READ_ONLY);
 
         editor_->setValue(value_);
 
@@ -156,13 +159,14 @@ void QtDoubleSpinBoxEditor::slotEditorValueChange(double value)
 
     if(property_ != 0)
     {
-        property_->setValue(value);
+        QtPropertyUndoRecorder recorder(property_);
+        property_->setDoubleValue(value);
     }
 }
 
 void QtDoubleSpinBoxEditor::onPropertyValueChange(QtProperty* property)
 {
-    value_ = property->getValue().toDouble();
+    value_ = property->getDoubleValue();
     if(editor_ != 0)
     {
         editor_->blockSignals(true);
@@ -171,32 +175,32 @@ void QtDoubleSpinBoxEditor::onPropertyValueChange(QtProperty* property)
     }
 }
 
-void QtDoubleSpinBoxEditor::slotSetAttribute(QtProperty *property, const QString &name)
+void QtDoubleSpinBoxEditor::slotSetAttribute(QtProperty *property, int atom)
 {
     if(NULL == editor_)
     {
         return;
     }
 
-    QVariant v = property->getAttribute(name);
-    if(name == QtAttributeName::MinValue)
+    QVariant v = property->getAttribute(atom);
+    if(atom == QtAttributeName::MIN_VALUE)
     {
         double minValue = (v.type() == QVariant::Double) ? v.toDouble() : std::numeric_limits<double>::min();
         editor_->setMinimum(minValue);
     }
-    else if(name == QtAttributeName::MaxValue)
+    else if(atom == QtAttributeName::MAX_VALUE)
     {
         double maxValue = (v.type() == QVariant::Double) ? v.toDouble() : std::numeric_limits<double>::max();
         editor_->setMaximum(maxValue);
     }
-    else if(name == QtAttributeName::Decimals)
+    else if(atom == QtAttributeName::DECIMALS)
     {
         if(v.type() == QVariant::Int)
         {
             editor_->setDecimals(v.toInt());
         }
     }
-    else if(name == QtAttributeName::ReadOnly)
+    else if(atom == QtAttributeName::READ_ONLY)
     {
         editor_->setReadOnly(v.type() == QVariant::Bool && v.toBool());
     }
@@ -217,7 +221,7 @@ QWidget* QtStringEditor::createEditor(QWidget *parent, QtPropertyEditorFactory *
         editor_ = new QLineEdit(parent);
         editor_->setText(value_);
 
-        slotSetAttribute(property_, QtAttributeName::ReadOnly);
+        slotSetAttribute(property_, QtAttributeName::READ_ONLY);
 
         connect(editor_, SIGNAL(editingFinished()), this, SLOT(slotEditFinished()));
     }
@@ -243,20 +247,21 @@ void QtStringEditor::slotEditFinished()
         value_ = text;
         if(property_ != 0)
         {
+            QtPropertyUndoRecorder recorder(property_);
             property_->setValue(value_);
         }
     }
 }
 
-void QtStringEditor::slotSetAttribute(QtProperty *property, const QString &name)
+void QtStringEditor::slotSetAttribute(QtProperty *property, int atom)
 {
     if(!editor_)
     {
         return;
     }
 
-    QVariant value = property->getAttribute(name);
-    if(name == QtAttributeName::ReadOnly)
+    QVariant value = property->getAttribute(atom);
+    if(atom == QtAttributeName::READ_ONLY)
     {
         if(value.type() == QVariant::Bool)
         {
@@ -270,8 +275,8 @@ QtEnumEditor::QtEnumEditor(QtProperty *property)
     : QtPropertyEditor(property)
     , editor_(NULL)
 {
-    value_ = property_->getValue().toInt();
-    connect(property_, SIGNAL(signalAttributeChange(QtProperty*,QString)), this, SLOT(slotSetAttribute(QtProperty*,QString)));
+    value_ = property_->getIntValue();
+    connect(property_->getNotifier(), SIGNAL(signalAttributeChange(QtProperty*,int)), this, SLOT(slotSetAttribute(QtProperty*,int)));
 }
 
 QWidget* QtEnumEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /*factory*/)
@@ -283,7 +288,7 @@ QWidget* QtEnumEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /
         editor_->setMinimumContentsLength(1);
         editor_->view()->setTextElideMode(Qt::ElideRight);
 
-        slotSetAttribute(property_, QtAttributeName::EnumName);
+        slotSetAttribute(property_, QtAttributeName::ENUM_NAME);
 
         editor_->setCurrentIndex(value_);
 
@@ -294,7 +299,7 @@ QWidget* QtEnumEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /
 
 void QtEnumEditor::onPropertyValueChange(QtProperty *property)
 {
-    value_ = property->getValue().toInt();
+    value_ = property->getIntValue();
     if(editor_ != NULL)
     {
         editor_->blockSignals(true);
@@ -308,17 +313,18 @@ void QtEnumEditor::slotEditorValueChange(int index)
     if(index != value_)
     {
         value_ = index;
-        property_->setValue(value_);
+        QtPropertyUndoRecorder recorder(property_);
+        property_->setIntValue(value_);
     }
 }
 
-void QtEnumEditor::slotSetAttribute(QtProperty * property, const QString &name)
+void QtEnumEditor::slotSetAttribute(QtProperty * property, int atom)
 {
-    if(name == QtAttributeName::EnumName)
+    if(atom == QtAttributeName::ENUM_NAME)
     {
         editor_->clear();
 
-        QStringList enumNames = property->getAttribute(QtAttributeName::EnumName).toStringList();
+        QStringList enumNames = property->getAttribute(QtAttributeName::ENUM_NAME).toStringList();
         editor_->addItems(enumNames);
     }
 }
@@ -328,10 +334,10 @@ QtEnumPairEditor::QtEnumPairEditor(QtProperty *property)
     : QtPropertyEditor(property)
     , editor_(NULL)
 {
-    enumValues_ = property_->getAttribute(QtAttributeName::EnumValues).toList();
+    enumValues_ = property_->getAttribute(QtAttributeName::ENUM_VALUES).toList();
     index_ = enumValues_.indexOf(property_->getValue());
 
-    connect(property_, SIGNAL(signalAttributeChange(QtProperty*,QString)), this, SLOT(slotSetAttribute(QtProperty*,QString)));
+    connect(property_->getNotifier(), SIGNAL(signalAttributeChange(QtProperty*,int)), this, SLOT(slotSetAttribute(QtProperty*,int)));
 }
 
 QWidget* QtEnumPairEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /*factory*/)
@@ -343,7 +349,7 @@ QWidget* QtEnumPairEditor::createEditor(QWidget *parent, QtPropertyEditorFactory
         editor_->setMinimumContentsLength(1);
         editor_->view()->setTextElideMode(Qt::ElideRight);
 
-        slotSetAttribute(property_, QtAttributeName::EnumName);
+        slotSetAttribute(property_, QtAttributeName::ENUM_NAME);
 
         editor_->setCurrentIndex(index_);
 
@@ -370,23 +376,24 @@ void QtEnumPairEditor::slotEditorValueChange(int index)
         index_ = index;
         if(index_ >= 0 && index_ < enumValues_.size())
         {
+            QtPropertyUndoRecorder recorder(property_);
             property_->setValue(enumValues_[index_]);
         }
     }
 }
 
-void QtEnumPairEditor::slotSetAttribute(QtProperty * property, const QString &name)
+void QtEnumPairEditor::slotSetAttribute(QtProperty * property, int atom)
 {
-    if(name == QtAttributeName::EnumName)
+    if(atom == QtAttributeName::ENUM_NAME)
     {
         editor_->clear();
 
-        QStringList enumNames = property->getAttribute(QtAttributeName::EnumName).toStringList();
+        QStringList enumNames = property->getAttribute(QtAttributeName::ENUM_NAME).toStringList();
         editor_->addItems(enumNames);
     }
-    else if(name == QtAttributeName::EnumValues)
+    else if(atom == QtAttributeName::ENUM_VALUES)
     {
-        enumValues_ = property->getAttribute(QtAttributeName::EnumValues).toList();
+        enumValues_ = property->getAttribute(QtAttributeName::ENUM_VALUES).toList();
 
         int index = std::max(0, enumValues_.indexOf(property->getValue()));
         if(index != index_)
@@ -403,8 +410,8 @@ QtFlagEditor::QtFlagEditor(QtProperty *property)
     : QtPropertyEditor(property)
     , editor_(NULL)
 {
-    value_ = property_->getValue().toInt();
-    connect(property_, SIGNAL(signalAttributeChange(QtProperty*,QString)), this, SLOT(slotSetAttribute(QtProperty*,QString)));
+    value_ = property_->getIntValue();
+    connect(property_->getNotifier(), SIGNAL(signalAttributeChange(QtProperty*,int)), this, SLOT(slotSetAttribute(QtProperty*,int)));
 }
 
 QWidget* QtFlagEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /*factory*/)
@@ -417,7 +424,7 @@ QWidget* QtFlagEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /
         editor_->view()->setTextElideMode(Qt::ElideRight);
         editor_->setSeparator("|");
 
-        slotSetAttribute(property_, QtAttributeName::FlagName);
+        slotSetAttribute(property_, QtAttributeName::FLAG_NAME);
         setValueToEditor(value_);
 
         connect(editor_, SIGNAL(checkedItemsChanged(QStringList)), this, SLOT(checkedItemsChanged(QStringList)));
@@ -442,7 +449,7 @@ void QtFlagEditor::setValueToEditor(int value)
 
 void QtFlagEditor::onPropertyValueChange(QtProperty *property)
 {
-    value_ = property->getValue().toInt();
+    value_ = property->getIntValue();
     if(NULL != editor_)
     {
         setValueToEditor(value_);
@@ -460,17 +467,18 @@ void QtFlagEditor::checkedItemsChanged(const QStringList& /*items*/)
     if(value != value_)
     {
         value_ = value;
-        property_->setValue(value_);
+        QtPropertyUndoRecorder recorder(property_);
+        property_->setIntValue(value_);
     }
 }
 
-void QtFlagEditor::slotSetAttribute(QtProperty * property, const QString &name)
+void QtFlagEditor::slotSetAttribute(QtProperty * property, int atom)
 {
-    if(name == QtAttributeName::FlagName)
+    if(atom == QtAttributeName::FLAG_NAME)
     {
         editor_->clear();
 
-        flagNames_ = property->getAttribute(QtAttributeName::FlagName).toStringList();
+        flagNames_ = property->getAttribute(QtAttributeName::FLAG_NAME).toStringList();
         editor_->addItems(flagNames_);
     }
 }
@@ -480,7 +488,7 @@ QtBoolEditor::QtBoolEditor(QtProperty *property)
     : QtPropertyEditor(property)
     , editor_(NULL)
 {
-    value_ = property_->getValue().toBool();
+    value_ = property_->getBoolValue();
 }
 
 QWidget* QtBoolEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /*factory*/)
@@ -497,7 +505,7 @@ QWidget* QtBoolEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /
 
 void QtBoolEditor::onPropertyValueChange(QtProperty * property)
 {
-    value_ = property->getValue().toBool();
+    value_ = property->getBoolValue();
     if(NULL != editor_)
     {
         editor_->blockSignals(true);
@@ -511,7 +519,8 @@ void QtBoolEditor::slotEditorValueChange(bool value)
     if(value != value_)
     {
         value_ = value;
-        property_->setValue(value_);
+        QtPropertyUndoRecorder recorder(property_);
+        property_->setBoolValue(value_);
     }
 }
 
@@ -520,7 +529,7 @@ QtColorEditor::QtColorEditor(QtProperty *property)
     : QtPropertyEditor(property)
     , editor_(NULL)
 {
-    value_ = QtPropertyBrowserUtils::variant2color(property->getValue());
+    value_ = property->getColorValue();
 }
 
 QWidget* QtColorEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /*factory*/)
@@ -537,7 +546,7 @@ QWidget* QtColorEditor::createEditor(QWidget *parent, QtPropertyEditorFactory *
 
 void QtColorEditor::onPropertyValueChange(QtProperty * property)
 {
-    value_ = QtPropertyBrowserUtils::variant2color(property->getValue());
+    value_ = property->getColorValue();
     if(NULL != editor_)
     {
         editor_->blockSignals(true);
@@ -551,7 +560,8 @@ void QtColorEditor::slotEditorValueChange(const QColor &color)
     if(color != value_)
     {
         value_ = color;
-        property_->setValue(QtPropertyBrowserUtils::color2variant(value_));
+        QtPropertyUndoRecorder recorder(property_);
+        property_->setColorValue(value_);
     }
 }
 
@@ -565,7 +575,7 @@ QtFileEditor::QtFileEditor(QtProperty *property)
     , dialogType_(READ_FILE)
 {
     value_ = property->getValue().toString();
-    connect(property_, SIGNAL(signalAttributeChange(QtProperty*,QString)), this, SLOT(slotSetAttribute(QtProperty*,QString)));
+    connect(property_->getNotifier(), SIGNAL(signalAttributeChange(QtProperty*,int)), this, SLOT(slotSetAttribute(QtProperty*,int)));
 }
 
 QWidget* QtFileEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /*factory*/)
@@ -597,10 +607,10 @@ QWidget* QtFileEditor::createEditor(QWidget *parent, QtPropertyEditorFactory * /
     connect(button_, SIGNAL(clicked()), this, SLOT(slotButtonClicked()));
     layout->addWidget(button_);
 
-    slotSetAttribute(property_, QtAttributeName::FileDialogType);
-    slotSetAttribute(property_, QtAttributeName::FileDialogFilter);
-    slotSetAttribute(property_, QtAttributeName::FileRelativePath);
-    slotSetAttribute(property_, QtAttributeName::ReadOnly);
+    slotSetAttribute(property_, QtAttributeName::FILE_DIALOG_TYPE);
+    slotSetAttribute(property_, QtAttributeName::FILE_DIALOG_FILTER);
+    slotSetAttribute(property_, QtAttributeName::FILE_RELATIVE_PATH);
+    slotSetAttribute(property_, QtAttributeName::READ_ONLY);
 
     return editor_;
 }
@@ -622,31 +632,31 @@ void QtFileEditor::slotEditorDestory(QObject *object)
     button_ = NULL;
 }
 
-void QtFileEditor::slotSetAttribute(QtProperty *property, const QString &name)
+void QtFileEditor::slotSetAttribute(QtProperty *property, int atom)
 {
-    QVariant value = property->getAttribute(name);
-    if(name == QtAttributeName::FileDialogType)
+    QVariant value = property->getAttribute(atom);
+    if(atom == QtAttributeName::FILE_DIALOG_TYPE)
     {
         if(value.type() == QVariant::Int)
         {
             dialogType_ = (DialogType)value.toInt();
         }
     }
-    else if(name == QtAttributeName::FileDialogFilter)
+    else if(atom == QtAttributeName::FILE_DIALOG_FILTER)
     {
         if(value.type() == QVariant::String)
         {
             filter_ = value.toString();
         }
     }
-    else if(name == QtAttributeName::FileRelativePath)
+    else if(atom == QtAttributeName::FILE_RELATIVE_PATH)
     {
         if(value.type() == QVariant::String)
         {
             relativePath_ = value.toString();
         }
     }
-    else if(name == QtAttributeName::ReadOnly)
+    else if(atom == QtAttributeName::READ_ONLY)
     {
         if(editor_ != NULL && value.type() == QVariant::Bool)
         {
@@ -676,6 +686,7 @@ void QtFileEditor::onFileSeleted(const QString &fullPath)
     if(path != value_)
     {
         setValue(path);
+        QtPropertyUndoRecorder recorder(property_);
         property_->setValue(path);
     }
 }
@@ -715,6 +726,7 @@ void QtFileEditor::slotEditingFinished()
     if(text != value_)
     {
         value_ = text;
+        QtPropertyUndoRecorder recorder(property_);
         property_->setValue(value_);
     }
 }
@@ -832,7 +844,7 @@ void QtDynamicItemEditor::onBtnMoveUp()
     QtDynamicItemProperty *property = dynamic_cast<QtDynamicItemProperty*>(property_);
     if(property != NULL)
     {
-        emit property->signalMoveUp(property);
+        property->moveUp();
     }
 }
 
@@ -841,7 +853,7 @@ void QtDynamicItemEditor::onBtnMoveDown()
     QtDynamicItemProperty *property = dynamic_cast<QtDynamicItemProperty*>(property_);
     if(property != NULL)
     {
-        emit property->signalMoveDown(property);
+        property->moveDown();
     }
 }
 
@@ -850,31 +862,39 @@ void QtDynamicItemEditor::onBtnDelete()
     QtDynamicItemProperty *property = dynamic_cast<QtDynamicItemProperty*>(property_);
     if(property != NULL)
     {
-        emit property->signalDelete(property);
+        property->remove();
     }
 }
 
 
 QtFloatListEditor::QtFloatListEditor(QtProperty *property)
     : QtPropertyEditor(property)
+    , floatList_(dynamic_cast<QtFloatListProperty*>(property))
     , size_(0)
 {
-    size_ = property->getAttribute(QtAttributeName::Size).toInt();
-    variantList2Vector(property->getValue().toList(), values_);
+    size_ = property->getAttribute(QtAttributeName::SIZE).toInt();
+    readValues(property, values_);
 }
 
-void QtFloatListEditor::variantList2Vector(const QList<QVariant> &input, QVector<float> &output)
+void QtFloatListEditor::readValues(QtProperty *property, QVector<float> &output)
 {
-    output.clear();
-
-    foreach(const QVariant &val, input)
+    if(property == floatList_ && floatList_ != NULL)
     {
-        output.push_back(val.toFloat());
+        // shares the property's data, nothing is copied.
+        output = floatList_->getValues();
+    }
+    else
+    {
+        output.clear();
+        foreach(const QVariant &val, property->getValue().toList())
+        {
+            output.push_back(val.toFloat());
+        }
     }
 
-    while(output.size() < size_)
+    if(output.size() < size_)
     {
-        output.push_back(0.0f);
+        output.resize(size_);
     }
 }
 
@@ -887,7 +907,7 @@ QWidget* QtFloatListEditor::createEditor(QWidget *parent, QtPropertyEditorFactor
     editor->setLayout(layout);
 
     QVector<float> values;
-    variantList2Vector(property_->getValue().toList(), values);
+    readValues(property_, values);
 
     for(int i = 0; i < size_; ++i)
     {
@@ -898,10 +918,10 @@ QWidget* QtFloatListEditor::createEditor(QWidget *parent, QtPropertyEditorFactor
         layout->addWidget(edt);
         editors_.push_back(edt);
 
-        setEditorAttribute(edt, property_, QtAttributeName::MinValue);
-        setEditorAttribute(edt, property_, QtAttributeName::MaxValue);
-        setEditorAttribute(edt, property_, QtAttributeName::Decimals);
-        setEditorAttribute(edt, property_, QtAttributeName::ReadOnly);
+        setEditorAttribute(edt, property_, QtAttributeName::MIN_VALUE);
+        setEditorAttribute(edt, property_, QtAttributeName::MAX_VALUE);
+        setEditorAttribute(edt, property_, QtAttributeName::DECIMALS);
+        setEditorAttribute(edt, property_, QtAttributeName::READ_ONLY);
 
         edt->setValue(values[i]);
         connect(edt, SIGNAL(valueChanged(double)), this, SLOT(slotEditorValueChange(double)));
@@ -916,29 +936,26 @@ QWidget* QtFloatListEditor::createEditor(QWidget *parent, QtPropertyEditorFactor
 
 void QtFloatListEditor::onPropertyValueChange(QtProperty *property)
 {
+    // read only access, the data stays shared with the property.
     QVector<float> values;
-    variantList2Vector(property->getValue().toList(), values);
+    readValues(property, values);
 
-    if(values.size() == values_.size())
+    // values_ is changed component by component, so it keeps its own data and
+    // only the spin boxes of changed components are touched.
+    if(values_.size() != values.size())
     {
-        int i = 0;
-        for( ; i < values.size(); ++i)
+        values_.resize(values.size());
+    }
+    for(int i = 0; i < values.size(); ++i)
+    {
+        if(!qFuzzyCompare(values.at(i), values_.at(i)))
         {
-            if(!qFuzzyCompare(values[i], values_[i]))
+            values_[i] = values.at(i);
+            if(i < editors_.size())
             {
-                break;
+                editors_[i]->setValue(values_.at(i));
             }
         }
-        if(i == values.size())
-        {
-            return;
-        }
-    }
-
-    values_ = values;
-    for(int i = 0; i < size_; ++i)
-    {
-        editors_[i]->setValue(values_[i]);
     }
 }
 
@@ -951,55 +968,65 @@ void QtFloatListEditor::slotEditorValueChange(double value)
     }
 
     int index = editors_.indexOf(edt);
-    if(qFuzzyCompare(values_[index], (float)value))
+    if(index < 0 || index >= values_.size() || qFuzzyCompare(values_.at(index), (float)value))
     {
         return;
     }
+
+    // the notification of the property finds values_ up to date and leaves the editors alone.
     values_[index] = (float)value;
 
+    if(floatList_ != NULL && values_.size() == floatList_->getValues().size())
+    {
+        QtPropertyUndoRecorder recorder(property_, index);
+        floatList_->setValueAt(index, (float)value);
+        return;
+    }
+
     QVariantList values;
     foreach(float val, values_)
     {
         values.push_back(QVariant((double)val));
     }
 
+    QtPropertyUndoRecorder recorder(property_);
     property_->setValue(QVariant(values));
 }
 
-void QtFloatListEditor::slotSetAttribute(QtProperty *property, const QString &name)
+void QtFloatListEditor::slotSetAttribute(QtProperty *property, int atom)
 {
     foreach(QDoubleSpinBox *editor, editors_)
     {
-        setEditorAttribute(editor, property, name);
+        setEditorAttribute(editor, property, atom);
     }
 }
 
-void QtFloatListEditor::setEditorAttribute(QDoubleSpinBox *editor, QtProperty *property, const QString &name)
+void QtFloatListEditor::setEditorAttribute(QDoubleSpinBox *editor, QtProperty *property, int atom)
 {
     if(NULL == editor)
     {
         return;
     }
 
-    QVariant v = property->getAttribute(name);
-    if(name == QtAttributeName::MinValue)
+    QVariant v = property->getAttribute(atom);
+    if(atom == QtAttributeName::MIN_VALUE)
     {
         double minValue = (v.type() == QVariant::Double) ? v.toDouble() : std::numeric_limits<double>::min();
         editor->setMinimum(minValue);
     }
-    else if(name == QtAttributeName::MaxValue)
+    else if(atom == QtAttributeName::MAX_VALUE)
     {
         double maxValue = (v.type() == QVariant::Double) ? v.toDouble() : std::numeric_limits<double>::max();
         editor->setMaximum(maxValue);
     }
-    else if(name == QtAttributeName::Decimals)
+    else if(atom == QtAttributeName::DECIMALS)
     {
         if(v.type() == QVariant::Int)
         {
             editor->setDecimals(v.toInt());
         }
     }
-    else if(name == QtAttributeName::ReadOnly)
+    else if(atom == QtAttributeName::READ_ONLY)
     {
         editor->setReadOnly(v.type() == QVariant::Bool && v.toBool());
     }
@@ -9,6 +9,7 @@
 #include <QVector>
 
 class QtProperty;
+class QtFloatListProperty;
 class QWidget;
 class QSpinBox;
 class QDoubleSpinBox;
@@ -35,7 +36,7 @@ public:
 
 public slots:
     virtual void onPropertyValueChange(QtProperty *property) = 0;
-    virtual void onPropertyDestory(QObject *object);
+    virtual void onPropertyDestory(QtProperty *property);
     virtual void slotEditorDestory(QObject *object);
 
 protected:
@@ -54,7 +55,7 @@ public:
 public slots:
     virtual void onPropertyValueChange(QtProperty *property);
     void slotEditorValueChange(int value);
-    void slotSetAttribute(QtProperty *property, const QString &name);
+    void slotSetAttribute(QtProperty *property, int atom);
 
 private:
     int                 value_;
@@ -72,7 +73,7 @@ public:
 public slots:
     virtual void onPropertyValueChange(QtProperty *property);
     void slotEditorValueChange(double value);
-    void slotSetAttribute(QtProperty *property, const QString &name);
+    void slotSetAttribute(QtProperty *property, int atom);
 
 private:
     double              value_;
@@ -90,7 +91,7 @@ public:
 public slots:
     virtual void onPropertyValueChange(QtProperty *property);
     void slotEditFinished();
-    void slotSetAttribute(QtProperty *property, const QString &name);
+    void slotSetAttribute(QtProperty *property, int atom);
 
 private:
     QString             value_;
@@ -107,7 +108,7 @@ public:
 public slots:
     virtual void onPropertyValueChange(QtProperty *property);
     virtual void slotEditorValueChange(int index);
-    virtual void slotSetAttribute(QtProperty *property, const QString &name);
+    virtual void slotSetAttribute(QtProperty *property, int atom);
 
 private:
     int                 value_;
@@ -124,7 +125,7 @@ public:
 public slots:
     virtual void onPropertyValueChange(QtProperty *property);
     virtual void slotEditorValueChange(int index);
-    virtual void slotSetAttribute(QtProperty *property, const QString &name);
+    virtual void slotSetAttribute(QtProperty *property, int atom);
 
 protected:
     int                 index_;
@@ -144,7 +145,7 @@ public:
 public slots:
     virtual void onPropertyValueChange(QtProperty *property);
     void checkedItemsChanged(const QStringList& items);
-    void slotSetAttribute(QtProperty *property, const QString &name);
+    void slotSetAttribute(QtProperty *property, int atom);
 
 private:
     int                 value_;
@@ -204,7 +205,7 @@ public slots:
 
     virtual void onPropertyValueChange(QtProperty *property);
     virtual void slotEditorDestory(QObject *object);
-    virtual void slotSetAttribute(QtProperty *property, const QString &name);
+    virtual void slotSetAttribute(QtProperty *property, int atom);
 
 protected:
     virtual bool eventFilter(QObject *obj, QEvent *event);
@@ -249,12 +250,13 @@ public:
 public slots:
     virtual void onPropertyValueChange(QtProperty *property);
     void slotEditorValueChange(double value);
-    void slotSetAttribute(QtProperty *property, const QString &name);
+    void slotSetAttribute(QtProperty *property, int atom);
 
 private:
-    void setEditorAttribute(QDoubleSpinBox *editor, QtProperty *property, const QString &name);
-    void variantList2Vector(const QList<QVariant> &input, QVector<float> &output);
+    void setEditorAttribute(QDoubleSpinBox *editor, QtProperty *property, int atom);
+    void readValues(QtProperty *property, QVector<float> &output);
 
+    QtFloatListProperty* floatList_; ///< 可以为NULL，此时通过QVariant读写
     int                 size_;
     QVector<float>      values_;
     QVector<QDoubleSpinBox*> editors_;
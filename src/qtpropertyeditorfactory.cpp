@@ -47,15 +47,26 @@ QtPropertyEditor* QtPropertyEditorFactory::createPropertyEditor(QtProperty *prop
         type = property->getType();
     }
 
-    QtPropertyEditorCreator method = creators_.value(type);
-    if(method != NULL)
+    if(type >= 0 && type < creators_.size())
     {
-        return method(property);
+        QtPropertyEditorCreator method = creators_[type];
+        if(method != NULL)
+        {
+            return method(property);
+        }
     }
     return NULL;
 }
 
 void QtPropertyEditorFactory::registerCreator(QtPropertyType::Type type, QtPropertyEditorCreator method)
 {
+    if(type < 0)
+    {
+        return;
+    }
+    if(type >= creators_.size())
+    {
+        creators_.resize(type + 1);
+    }
     creators_[type] = method;
 }
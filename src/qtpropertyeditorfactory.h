@@ -2,7 +2,7 @@
 #define QTPROPERTYEDITORFACTORY_H
 
 #include <QObject>
-#include <QMap>
+#include <QVector>
 #include "qtpropertytype.h"
 
 class QWidget;
@@ -30,8 +30,9 @@ private:
     template <typename T>
     static QtPropertyEditor* internalCreator(QtProperty *property);
 
-    typedef QMap<QtPropertyType::Type, QtPropertyEditorCreator> CreatorMap;
-    CreatorMap      creators_;
+    // indexed by type id.
+    typedef QVector<QtPropertyEditorCreator> CreatorArray;
+    CreatorArray    creators_;
 };
 
 template <typename T>
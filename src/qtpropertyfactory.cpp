@@ -1,9 +1,15 @@
 ﻿#include "qtpropertyfactory.h"
 #include "qtproperty.h"
+#include "qtpropertydefinition.h"
+#include "qtpropertyarena.h"
+#include "qtpropertyschema.h"
 
 
 QtPropertyFactory::QtPropertyFactory(QObject *parent)
     : QObject(parent)
+    , dispatchDepth_(0)
+    , arena_(NULL)
+    , arenaEnabled_(false)
 {
 #define REGISTER_PROPERTY(TYPE, CLASS) \
     registerCreator(TYPE, new QtSimplePropertyCreator<CLASS>(TYPE, this))
@@ -25,30 +31,204 @@ QtPropertyFactory::QtPropertyFactory(QObject *parent)
 
 QtPropertyFactory::~QtPropertyFactory()
 {
-    for(CreatorMap::iterator it = propertyCreator_.begin(); it != propertyCreator_.end(); ++it)
+    foreach(QtPropertyCreator *method, propertyCreator_)
     {
-        delete it.value();
+        delete method;
+    }
+
+    // properties still alive keep the arena, it goes with the last of them.
+    if(arena_ != NULL)
+    {
+        arena_->detach();
     }
 }
 
+void QtPropertyFactory::setArenaEnabled(bool enable)
+{
+    // the arena is kept when disabled, properties already in it still need it.
+    if(enable && arena_ == NULL)
+    {
+        arena_ = new QtPropertyArena();
+    }
+    arenaEnabled_ = enable;
+}
+
 QtProperty* QtPropertyFactory::createProperty(QtPropertyType::Type type)
 {
-    QtPropertyCreator *method = propertyCreator_.value(type);
-    if(method != NULL)
+    if(type >= 0 && type < propertyCreator_.size())
     {
-        return method->create();
+        QtPropertyCreator *method = propertyCreator_[type];
+        if(method != NULL)
+        {
+            return method->create();
+        }
     }
     
     // use default QtProperty
-    return new QtProperty(type, this);
+    return new (getArena()) QtProperty(type, this);
+}
+
+QtProperty* QtPropertyFactory::createProperty(const QString &typeName)
+{
+    return createProperty(QtPropertyType::registerType(typeName));
+}
+
+QtProperty* QtPropertyFactory::createProperty(const QtPropertyDefinition &definition)
+{
+    QtProperty *property = createSubtree(definition);
+    if(definition.getDefaultValue().isValid())
+    {
+        property->setValue(definition.getDefaultValue());
+    }
+    return property;
+}
+
+QtProperty* QtPropertyFactory::createProperty(const QtPropertySchema &schema)
+{
+    QtProperty *prototype = schema.getPrototype(this);
+    return prototype != NULL ? prototype->clone() : NULL;
+}
+
+QtProperty* QtPropertyFactory::createSubtree(const QtPropertyDefinition &definition)
+{
+    QtProperty *property = createProperty(definition.getType());
+    property->setDefinition(definition);
+
+    foreach(const QtPropertyDefinition &childDefinition, definition.getChildren())
+    {
+        QtProperty *child = createSubtree(childDefinition);
+        property->addChild(child);
+
+        // assign the value after the child is attached, so that containers can collect it.
+        if(childDefinition.getDefaultValue().isValid())
+        {
+            child->setValue(childDefinition.getDefaultValue());
+        }
+    }
+    return property;
 }
 
 void QtPropertyFactory::registerCreator(QtPropertyType::Type type, QtPropertyCreator *method)
 {
-    QtPropertyCreator *p = propertyCreator_.value(type);
+    if(type < 0)
+    {
+        delete method;
+        return;
+    }
+    if(type >= propertyCreator_.size())
+    {
+        propertyCreator_.resize(type + 1);
+    }
+
+    QtPropertyCreator *p = propertyCreator_[type];
     if(p != NULL)
     {
         delete p;
     }
     propertyCreator_[type] = method;
 }
+
+/********************************************************************/
+void QtPropertyListener::onChildrenInsert(QtProperty *parent, int first, int last)
+{
+    for(int i = first; i <= last; ++i)
+    {
+        onPropertyInsert(parent->getChildren()[i], parent);
+    }
+}
+
+/********************************************************************/
+void QtPropertyFactory::addListener(QtPropertyListener *listener)
+{
+    if(!listeners_.contains(listener))
+    {
+        listeners_.push_back(listener);
+    }
+}
+
+void QtPropertyFactory::removeListener(QtPropertyListener *listener)
+{
+    if(dispatchDepth_ == 0)
+    {
+        listeners_.removeOne(listener);
+        return;
+    }
+
+    // a dispatch is walking the array, the slot is compacted when it ends.
+    int index = listeners_.indexOf(listener);
+    if(index >= 0)
+    {
+        listeners_[index] = NULL;
+    }
+}
+
+void QtPropertyFactory::endDispatch()
+{
+    if(--dispatchDepth_ == 0)
+    {
+        listeners_.removeAll(NULL);
+    }
+}
+
+// listeners are called by index, a listener removed by a handler is skipped
+// and one added by a handler waits for the next notification.
+#define DISPATCH_TO_LISTENERS(CALL) \
+    ++dispatchDepth_; \
+    for(int i = 0, count = listeners_.size(); i < count; ++i) \
+    { \
+        QtPropertyListener *listener = listeners_[i]; \
+        if(listener != NULL) \
+        { \
+            listener->CALL; \
+        } \
+    } \
+    endDispatch()
+
+void QtPropertyFactory::dispatchPropertyInsert(QtProperty *property, QtProperty *parent)
+{
+    DISPATCH_TO_LISTENERS(onPropertyInsert(property, parent));
+}
+
+void QtPropertyFactory::dispatchPropertyRemove(QtProperty *property, QtProperty *parent)
+{
+    DISPATCH_TO_LISTENERS(onPropertyRemove(property, parent));
+}
+
+void QtPropertyFactory::dispatchValueChange(QtProperty *property)
+{
+    DISPATCH_TO_LISTENERS(onPropertyValueChange(property));
+}
+
+void QtPropertyFactory::dispatchPropertyChange(QtProperty *property)
+{
+    DISPATCH_TO_LISTENERS(onPropertyPropertyChange(property));
+}
+
+void QtPropertyFactory::dispatchAttributeChange(QtProperty *property, int atom)
+{
+    DISPATCH_TO_LISTENERS(onPropertyAttributeChange(property, atom));
+}
+
+void QtPropertyFactory::dispatchPropertyReorder(QtProperty *parent)
+{
+    DISPATCH_TO_LISTENERS(onPropertyReorder(parent));
+}
+
+void QtPropertyFactory::dispatchChildrenInsert(QtProperty *parent, int first, int last)
+{
+    DISPATCH_TO_LISTENERS(onChildrenInsert(parent, first, last));
+}
+
+#undef DISPATCH_TO_LISTENERS
+
+bool QtPropertyFactory::isChildrenInUse(QtProperty *property) const
+{
+    foreach(QtPropertyListener *listener, listeners_)
+    {
+        if(listener != NULL && listener->isChildrenInUse(property))
+        {
+            return true;
+        }
+    }
+    return false;
+}
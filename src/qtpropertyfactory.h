@@ -1,12 +1,16 @@
-#ifndef QTPROPERTYMANAGER_H
+﻿#ifndef QTPROPERTYMANAGER_H
 #define QTPROPERTYMANAGER_H
 
 #include <QObject>
+#include <QVector>
 #include <QHash>
 #include "qtpropertytype.h"
 
 class QtProperty;
 class QtPropertyFactory;
+class QtPropertyDefinition;
+class QtPropertySchema;
+class QtPropertyArena;
 
 class QtPropertyCreator
 {
@@ -15,6 +19,31 @@ public:
     virtual QtProperty* create() = 0;
 };
 
+/**
+ * @brief The QtPropertyListener class
+ *
+ * Receives the changes of every property created by a factory, without any
+ * per property connection. Listeners filter the properties they care about.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyListener
+{
+public:
+    virtual ~QtPropertyListener(){}
+
+    virtual void onPropertyInsert(QtProperty * /*property*/, QtProperty * /*parent*/){}
+    virtual void onPropertyRemove(QtProperty * /*property*/, QtProperty * /*parent*/){}
+    virtual void onPropertyValueChange(QtProperty * /*property*/){}
+    virtual void onPropertyPropertyChange(QtProperty * /*property*/){}
+    virtual void onPropertyAttributeChange(QtProperty * /*property*/, int /*atom*/){}
+    virtual void onPropertyReorder(QtProperty * /*parent*/){}
+
+    /** parent的first到last位置的子属性被一次插入。默认逐个转给onPropertyInsert。*/
+    virtual void onChildrenInsert(QtProperty *parent, int first, int last);
+
+    /** property的子属性是否正在被显示或绑定。返回true时懒加载的子属性不会被释放。*/
+    virtual bool isChildrenInUse(QtProperty * /*property*/){ return false; }
+};
+
 class QTPROPERTYSHEET_DLL QtPropertyFactory : public QObject
 {
     Q_OBJECT
@@ -22,16 +51,69 @@ public:
     explicit QtPropertyFactory(QObject *parent = 0);
     virtual ~QtPropertyFactory();
 
+    /** 创建属性。属性不是factory的子对象，调用者负责delete属性树的根。
+     *  factory可以先于属性销毁，此后属性不再通知factory的监听者。
+     */
     QtProperty* createProperty(QtPropertyType::Type type);
 
+    /** 按类型名称创建属性，兼容字符串类型。未注册的名称会被自动注册。*/
+    QtProperty* createProperty(const QString &typeName);
+
+    /** 按定义创建属性及其整棵子树。新属性共享definition中的描述数据，
+     *  并以定义中的默认值作为初始值。
+     */
+    QtProperty* createProperty(const QtPropertyDefinition &definition);
+
+    /** 按schema创建属性树。第一次调用时执行schema的指令列表，并把结果作为原型
+     *  保存在schema中，以后的调用直接clone原型。
+     */
+    QtProperty* createProperty(const QtPropertySchema &schema);
+
     void registerCreator(QtPropertyType::Type type, QtPropertyCreator *method);
 
     template<typename T>
     void registerSimpleCreator(QtPropertyType::Type type);
 
+    /** 开启后，新创建的属性分配在factory的arena上，同一棵树的节点在内存中连续存放。
+     *  内存块中的属性全部delete后，内存块被重用；factory之后仍存活的属性继续持有arena。
+     */
+    void setArenaEnabled(bool enable);
+    bool isArenaEnabled() const { return arenaEnabled_; }
+    QtPropertyArena* getArena() const { return arenaEnabled_ ? arena_ : NULL; }
+
+    /** 监听本factory创建的所有属性。factory不负责delete listener。
+     *  分发过程中可以添加或移除listener，被移除的不会再收到这次通知。
+     */
+    void addListener(QtPropertyListener *listener);
+    void removeListener(QtPropertyListener *listener);
+
+    void dispatchPropertyInsert(QtProperty *property, QtProperty *parent);
+    void dispatchPropertyRemove(QtProperty *property, QtProperty *parent);
+    void dispatchValueChange(QtProperty *property);
+    void dispatchPropertyChange(QtProperty *property);
+    void dispatchAttributeChange(QtProperty *property, int atom);
+    void dispatchPropertyReorder(QtProperty *parent);
+    void dispatchChildrenInsert(QtProperty *parent, int first, int last);
+
+    /** 任何一个listener正在使用property的子属性。*/
+    bool isChildrenInUse(QtProperty *property) const;
+
 private:
-    typedef QHash<QtPropertyType::Type, QtPropertyCreator*> CreatorMap;
-    CreatorMap      propertyCreator_;
+    QtProperty* createSubtree(const QtPropertyDefinition &definition);
+
+    /** 分发结束后压缩被移除的listener留下的空位。*/
+    void endDispatch();
+
+    // indexed by type id.
+    typedef QVector<QtPropertyCreator*> CreatorArray;
+    CreatorArray    propertyCreator_;
+
+    typedef QVector<QtPropertyListener*> ListenerArray;
+    ListenerArray   listeners_;
+    int             dispatchDepth_;
+
+    QtPropertyArena* arena_;
+    bool            arenaEnabled_;
 };
 
 
@@ -48,7 +130,7 @@ public:
 
     virtual QtProperty* create()
     {
-        return new T(type_, factory_);
+        return new (factory_->getArena()) T(type_, factory_);
     }
 };
 
@@ -0,0 +1,1019 @@
+﻿#include "qtpropertyjson.h"
+#include "qtproperty.h"
+#include "qtpropertyvalue.h"
+
+#include <QIODevice>
+#include <QVariant>
+#include <QVector>
+#include <QLocale>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+    const int CHUNK_SIZE = 64 * 1024;
+
+    /** 读取动态列表时每次最多增加的元素数量。*/
+    const int LIST_GROW_STEP = 256;
+}
+
+/** 把JSON文本写入缓冲区，缓冲区满时写到device。*/
+class QtJsonWriter
+{
+public:
+    QtJsonWriter(QIODevice *device, bool indented)
+        : device_(device)
+        , indented_(indented)
+        , depth_(0)
+        , ok_(true)
+    {
+        buffer_.reserve(CHUNK_SIZE + 1024);
+    }
+
+    void writeProperty(const QtProperty *property);
+    void writeVariant(const QVariant &value);
+
+    bool finish();
+    const QByteArray& getBuffer() const { return buffer_; }
+
+private:
+    void beginObject(){ buffer_ += '{'; ++depth_; }
+    void endObject(bool empty){ --depth_; if(!empty) newLine(); buffer_ += '}'; }
+    void beginArray(){ buffer_ += '['; ++depth_; }
+    void endArray(bool empty){ --depth_; if(!empty) newLine(); buffer_ += ']'; }
+
+    /** 第index个元素之前的分隔符。*/
+    void separator(int index){ if(index > 0) buffer_ += ','; newLine(); }
+    void key(const QString &name);
+
+    void newLine();
+    void writeString(const QString &str);
+    void writeInt(qint64 value){ buffer_ += QByteArray::number(value); }
+    void writeDouble(double value);
+    void writeFloat(float value);
+    void writeBool(bool value){ buffer_ += value ? "true" : "false"; }
+    void writeColor(const QColor &color);
+    void flush();
+
+    QIODevice*  device_;
+    QByteArray  buffer_;
+    bool        indented_;
+    int         depth_;
+    bool        ok_;
+};
+
+void QtJsonWriter::newLine()
+{
+    if(indented_)
+    {
+        buffer_ += '\n';
+        buffer_.append(QByteArray(depth_ * 4, ' '));
+    }
+    flush();
+}
+
+void QtJsonWriter::key(const QString &name)
+{
+    writeString(name);
+    buffer_ += indented_ ? ": " : ":";
+}
+
+void QtJsonWriter::flush()
+{
+    if(device_ != NULL && buffer_.size() >= CHUNK_SIZE)
+    {
+        ok_ = ok_ && device_->write(buffer_) == buffer_.size();
+        buffer_.resize(0);
+    }
+}
+
+bool QtJsonWriter::finish()
+{
+    if(indented_)
+    {
+        buffer_ += '\n';
+    }
+    if(device_ != NULL && !buffer_.isEmpty())
+    {
+        ok_ = ok_ && device_->write(buffer_) == buffer_.size();
+        buffer_.resize(0);
+    }
+    return ok_;
+}
+
+void QtJsonWriter::writeString(const QString &str)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    QByteArray utf8 = str.toUtf8();
+    buffer_ += '"';
+    for(int i = 0; i < utf8.size(); ++i)
+    {
+        uchar c = utf8[i];
+        switch(c)
+        {
+        case '"': buffer_ += "\\\""; break;
+        case '\\': buffer_ += "\\\\"; break;
+        case '\b': buffer_ += "\\b"; break;
+        case '\f': buffer_ += "\\f"; break;
+        case '\n': buffer_ += "\\n"; break;
+        case '\r': buffer_ += "\\r"; break;
+        case '\t': buffer_ += "\\t"; break;
+        default:
+            if(c < 0x20)
+            {
+                buffer_ += "\\u00";
+                buffer_ += hex[c >> 4];
+                buffer_ += hex[c & 0xf];
+            }
+            else
+            {
+                buffer_ += char(c);
+            }
+            break;
+        }
+    }
+    buffer_ += '"';
+}
+
+void QtJsonWriter::writeDouble(double value)
+{
+    if(!std::isfinite(value))
+    {
+        buffer_ += "null";
+        return;
+    }
+    buffer_ += QByteArray::number(value, 'g', QLocale::FloatingPointShortest);
+}
+
+void QtJsonWriter::writeFloat(float value)
+{
+    if(!std::isfinite(value))
+    {
+        buffer_ += "null";
+        return;
+    }
+
+    // the shortest text that reads back as the same float.
+    QByteArray text;
+    for(int precision = 6; precision <= 9; ++precision)
+    {
+        text = QByteArray::number(double(value), 'g', precision);
+        if(text.toFloat() == value)
+        {
+            break;
+        }
+    }
+    buffer_ += text;
+}
+
+void QtJsonWriter::writeColor(const QColor &color)
+{
+    buffer_ += '[';
+    writeInt(color.red());
+    buffer_ += ',';
+    writeInt(color.green());
+    buffer_ += ',';
+    writeInt(color.blue());
+    buffer_ += ',';
+    writeInt(color.alpha());
+    buffer_ += ']';
+}
+
+void QtJsonWriter::writeVariant(const QVariant &value)
+{
+    switch(value.type())
+    {
+    case QVariant::Invalid:
+        buffer_ += "null";
+        break;
+    case QVariant::Bool:
+        writeBool(value.toBool());
+        break;
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+        writeInt(value.toLongLong());
+        break;
+    case QVariant::Double:
+        writeDouble(value.toDouble());
+        break;
+    case QVariant::Color:
+        writeColor(value.value<QColor>());
+        break;
+    case QVariant::List:
+    case QVariant::StringList:
+    {
+        QVariantList list = value.toList();
+        beginArray();
+        for(int i = 0; i < list.size(); ++i)
+        {
+            separator(i);
+            writeVariant(list[i]);
+        }
+        endArray(list.isEmpty());
+        break;
+    }
+    case QVariant::Map:
+    {
+        QVariantMap map = value.toMap();
+        int index = 0;
+        beginObject();
+        for(QVariantMap::const_iterator it = map.constBegin(); it != map.constEnd(); ++it)
+        {
+            separator(index++);
+            key(it.key());
+            writeVariant(it.value());
+        }
+        endObject(map.isEmpty());
+        break;
+    }
+    default:
+        writeString(value.toString());
+        break;
+    }
+}
+
+void QtJsonWriter::writeProperty(const QtProperty *property)
+{
+    const QtDynamicItemProperty *item = dynamic_cast<const QtDynamicItemProperty*>(property);
+    if(item != NULL)
+    {
+        writeProperty(item->getImpl());
+        return;
+    }
+
+    const QtDynamicListProperty *dynamicList = dynamic_cast<const QtDynamicListProperty*>(property);
+    if(dynamicList != NULL)
+    {
+        beginArray();
+        for(int i = 0; i < dynamicList->getLength(); ++i)
+        {
+            separator(i);
+            writeProperty(dynamicList->getItem(i));
+        }
+        endArray(dynamicList->getLength() == 0);
+        return;
+    }
+
+    const QtFloatListProperty *floatList = dynamic_cast<const QtFloatListProperty*>(property);
+    if(floatList != NULL)
+    {
+        const QVector<float> &values = floatList->getValues();
+        beginArray();
+        for(int i = 0; i < values.size(); ++i)
+        {
+            separator(i);
+            writeFloat(values[i]);
+        }
+        endArray(values.isEmpty());
+        return;
+    }
+
+    if(dynamic_cast<const QtContainerProperty*>(property) != NULL)
+    {
+        const QtPropertyList &children = property->getChildren();
+        bool isList = dynamic_cast<const QtListProperty*>(property) != NULL;
+        if(isList)
+        {
+            beginArray();
+        }
+        else
+        {
+            beginObject();
+        }
+        for(int i = 0; i < children.size(); ++i)
+        {
+            separator(i);
+            if(!isList)
+            {
+                key(children[i]->getName());
+            }
+            writeProperty(children[i]);
+        }
+        if(isList)
+        {
+            endArray(children.isEmpty());
+        }
+        else
+        {
+            endObject(children.isEmpty());
+        }
+        return;
+    }
+
+    switch(property->getValueKind())
+    {
+    case QtPropertyValue::NONE:
+        buffer_ += "null";
+        break;
+    case QtPropertyValue::INT:
+        writeInt(property->getIntValue());
+        break;
+    case QtPropertyValue::DOUBLE:
+        writeDouble(property->getDoubleValue());
+        break;
+    case QtPropertyValue::BOOL:
+        writeBool(property->getBoolValue());
+        break;
+    case QtPropertyValue::COLOR:
+        writeColor(property->getColorValue());
+        break;
+    default:
+        writeVariant(property->getValue());
+        break;
+    }
+}
+
+/********************************************************************/
+/** 从device分块读取的JSON词法分析器，属性树按需从中拉取值。*/
+class QtJsonReader
+{
+public:
+    QtJsonReader(QIODevice *device, const QByteArray &data)
+        : device_(device)
+        , buffer_(data)
+        , pos_(0)
+        , consumed_(0)
+    {}
+
+    bool readProperty(QtProperty *property);
+    bool readDocument(QtProperty *root);
+
+    const QString& getError() const { return error_; }
+
+private:
+    /** 保证缓冲区中还有数据，需要时从device读取下一块。*/
+    bool fill();
+
+    /** 跳过空白，返回下一个字符但不消耗它，结束时返回0。*/
+    char peek();
+    char get();
+    bool expect(char c);
+    bool fail(const QString &message);
+
+    /** 读取对象的下一个键。返回false表示对象结束或出错，二者由error_区分。*/
+    bool nextKey(QString &key, bool &first);
+    bool nextElement(bool &first);
+
+    bool readHex(ushort &code);
+    bool readString(QString &str);
+    bool readNumber(QVariant &value);
+    bool readLiteral(const char *literal);
+    bool readValue(QVariant &value);
+
+    /** 跳过一个值，只检查语法，不创建QVariant。*/
+    bool skipValue();
+    bool skipString();
+    bool skipNumber();
+
+    bool readFloatList(QtFloatListProperty *property);
+    bool readDynamicList(QtDynamicListProperty *property);
+    bool readChildren(QtProperty *property);
+
+    QIODevice*  device_;
+    QByteArray  buffer_;
+    int         pos_;
+    qint64      consumed_;  ///< 已经丢弃的缓冲区长度，用于报告出错位置
+    QString     error_;
+};
+
+bool QtJsonReader::fill()
+{
+    if(pos_ < buffer_.size())
+    {
+        return true;
+    }
+    if(device_ == NULL)
+    {
+        return false;
+    }
+
+    consumed_ += buffer_.size();
+    buffer_ = device_->read(CHUNK_SIZE);
+    pos_ = 0;
+    return !buffer_.isEmpty();
+}
+
+char QtJsonReader::peek()
+{
+    while(fill())
+    {
+        char c = buffer_[pos_];
+        if(c != ' ' && c != '\t' && c != '\n' && c != '\r')
+        {
+            return c;
+        }
+        ++pos_;
+    }
+    return 0;
+}
+
+char QtJsonReader::get()
+{
+    return fill() ? buffer_[pos_++] : 0;
+}
+
+bool QtJsonReader::fail(const QString &message)
+{
+    if(error_.isEmpty())
+    {
+        error_ = QString("%1 at offset %2").arg(message).arg(consumed_ + pos_);
+    }
+    return false;
+}
+
+bool QtJsonReader::expect(char c)
+{
+    if(peek() != c)
+    {
+        return fail(QString("expected '%1'").arg(QChar(c)));
+    }
+    ++pos_;
+    return true;
+}
+
+bool QtJsonReader::nextKey(QString &key, bool &first)
+{
+    char c = peek();
+    if(c == '}')
+    {
+        ++pos_;
+        return false;
+    }
+    if(!first)
+    {
+        if(c != ',')
+        {
+            return fail("expected ',' or '}'");
+        }
+        ++pos_;
+    }
+    first = false;
+    return readString(key) && expect(':');
+}
+
+bool QtJsonReader::nextElement(bool &first)
+{
+    char c = peek();
+    if(c == ']')
+    {
+        ++pos_;
+        return false;
+    }
+    if(!first)
+    {
+        if(c != ',')
+        {
+            return fail("expected ',' or ']'");
+        }
+        ++pos_;
+    }
+    first = false;
+    return true;
+}
+
+bool QtJsonReader::readHex(ushort &code)
+{
+    QByteArray digits;
+    for(int i = 0; i < 4; ++i)
+    {
+        digits += get();
+    }
+
+    bool ok = false;
+    code = digits.toUShort(&ok, 16);
+    return ok || fail("invalid unicode escape");
+}
+
+bool QtJsonReader::readString(QString &str)
+{
+    if(!expect('"'))
+    {
+        return false;
+    }
+
+    QByteArray utf8;
+    for(;;)
+    {
+        char c = get();
+        if(c == '"')
+        {
+            break;
+        }
+        else if(c == 0)
+        {
+            return fail("unterminated string");
+        }
+        else if(c != '\\')
+        {
+            utf8 += c;
+            continue;
+        }
+
+        c = get();
+        switch(c)
+        {
+        case '"': utf8 += '"'; break;
+        case '\\': utf8 += '\\'; break;
+        case '/': utf8 += '/'; break;
+        case 'b': utf8 += '\b'; break;
+        case 'f': utf8 += '\f'; break;
+        case 'n': utf8 += '\n'; break;
+        case 'r': utf8 += '\r'; break;
+        case 't': utf8 += '\t'; break;
+        case 'u':
+        {
+            ushort code;
+            if(!readHex(code))
+            {
+                return false;
+            }
+
+            QString unit;
+            unit += QChar(code);
+            if(QChar::isHighSurrogate(code))
+            {
+                // the low half follows as a second escape.
+                ushort low;
+                if(get() != '\\' || get() != 'u' || !readHex(low) || !QChar::isLowSurrogate(low))
+                {
+                    return fail("invalid surrogate pair");
+                }
+                unit += QChar(low);
+            }
+            utf8 += unit.toUtf8();
+            break;
+        }
+        default:
+            return fail("invalid escape");
+        }
+    }
+
+    str = QString::fromUtf8(utf8);
+    return true;
+}
+
+bool QtJsonReader::readNumber(QVariant &value)
+{
+    QByteArray text;
+    bool integral = true;
+    peek();
+    while(fill())
+    {
+        char c = buffer_[pos_];
+        if(c == '.' || c == 'e' || c == 'E')
+        {
+            integral = false;
+        }
+        else if(c != '-' && c != '+' && (c < '0' || c > '9'))
+        {
+            break;
+        }
+        text += c;
+        ++pos_;
+    }
+
+    bool ok = false;
+    if(integral)
+    {
+        qint64 v = text.toLongLong(&ok);
+        if(ok)
+        {
+            value = v;
+            return true;
+        }
+    }
+
+    double v = text.toDouble(&ok);
+    if(!ok)
+    {
+        return fail("invalid number");
+    }
+    value = v;
+    return true;
+}
+
+bool QtJsonReader::readLiteral(const char *literal)
+{
+    peek();
+    for(const char *p = literal; *p != 0; ++p)
+    {
+        if(get() != *p)
+        {
+            return fail(QString("invalid literal, expected '%1'").arg(literal));
+        }
+    }
+    return true;
+}
+
+bool QtJsonReader::readValue(QVariant &value)
+{
+    char c = peek();
+    switch(c)
+    {
+    case '{':
+    {
+        ++pos_;
+        QVariantMap map;
+        QString key;
+        bool first = true;
+        while(nextKey(key, first))
+        {
+            QVariant item;
+            if(!readValue(item))
+            {
+                return false;
+            }
+            map.insert(key, item);
+        }
+        value = map;
+        return error_.isEmpty();
+    }
+    case '[':
+    {
+        ++pos_;
+        QVariantList list;
+        bool first = true;
+        while(nextElement(first))
+        {
+            QVariant item;
+            if(!readValue(item))
+            {
+                return false;
+            }
+            list.push_back(item);
+        }
+        value = list;
+        return error_.isEmpty();
+    }
+    case '"':
+    {
+        QString str;
+        if(!readString(str))
+        {
+            return false;
+        }
+        value = str;
+        return true;
+    }
+    case 't':
+        value = true;
+        return readLiteral("true");
+    case 'f':
+        value = false;
+        return readLiteral("false");
+    case 'n':
+        value = QVariant();
+        return readLiteral("null");
+    case 0:
+        return fail("unexpected end of data");
+    default:
+        return readNumber(value);
+    }
+}
+
+bool QtJsonReader::skipValue()
+{
+    char c = peek();
+    switch(c)
+    {
+    case '{':
+    {
+        ++pos_;
+        bool first = true;
+        for(;;)
+        {
+            c = peek();
+            if(c == '}')
+            {
+                ++pos_;
+                return true;
+            }
+            if(!first)
+            {
+                if(c != ',')
+                {
+                    return fail("expected ',' or '}'");
+                }
+                ++pos_;
+            }
+            first = false;
+            if(!skipString() || !expect(':') || !skipValue())
+            {
+                return false;
+            }
+        }
+    }
+    case '[':
+    {
+        ++pos_;
+        bool first = true;
+        while(nextElement(first))
+        {
+            if(!skipValue())
+            {
+                return false;
+            }
+        }
+        return error_.isEmpty();
+    }
+    case '"':
+        return skipString();
+    case 't':
+        return readLiteral("true");
+    case 'f':
+        return readLiteral("false");
+    case 'n':
+        return readLiteral("null");
+    case 0:
+        return fail("unexpected end of data");
+    default:
+        return skipNumber();
+    }
+}
+
+bool QtJsonReader::skipString()
+{
+    if(!expect('"'))
+    {
+        return false;
+    }
+
+    for(;;)
+    {
+        char c = get();
+        if(c == '"')
+        {
+            return true;
+        }
+        else if(c == 0)
+        {
+            return fail("unterminated string");
+        }
+        else if(c != '\\')
+        {
+            continue;
+        }
+
+        c = get();
+        if(c == 'u')
+        {
+            ushort code;
+            if(!readHex(code))
+            {
+                return false;
+            }
+        }
+        else if(c == 0 || strchr("\"\\/bfnrt", c) == NULL)
+        {
+            return fail("invalid escape");
+        }
+    }
+}
+
+bool QtJsonReader::skipNumber()
+{
+    int length = 0;
+    peek();
+    while(fill())
+    {
+        char c = buffer_[pos_];
+        if(c != '.' && c != 'e' && c != 'E' && c != '-' && c != '+' && (c < '0' || c > '9'))
+        {
+            break;
+        }
+        ++length;
+        ++pos_;
+    }
+    return length > 0 || fail("invalid number");
+}
+
+bool QtJsonReader::readFloatList(QtFloatListProperty *property)
+{
+    if(!expect('['))
+    {
+        return false;
+    }
+
+    QVector<float> values;
+    bool first = true;
+    while(nextElement(first))
+    {
+        QVariant value;
+        if(!readNumber(value))
+        {
+            return false;
+        }
+        values.push_back(value.toFloat());
+    }
+    if(!error_.isEmpty())
+    {
+        return false;
+    }
+
+    property->setValues(values);
+    return true;
+}
+
+bool QtJsonReader::readDynamicList(QtDynamicListProperty *property)
+{
+    if(!expect('['))
+    {
+        return false;
+    }
+
+    // the length is unknown until the end, grow in bounded steps and trim once.
+    int count = 0;
+    bool first = true;
+    while(nextElement(first))
+    {
+        if(count >= property->getLength())
+        {
+            int step = std::min(std::max(count, 1), LIST_GROW_STEP);
+            property->setLength(count + step);
+        }
+        if(!readProperty(property->getItem(count)))
+        {
+            return false;
+        }
+        ++count;
+    }
+    if(!error_.isEmpty())
+    {
+        return false;
+    }
+
+    property->setLength(count);
+    return true;
+}
+
+bool QtJsonReader::readChildren(QtProperty *property)
+{
+    if(peek() == '[')
+    {
+        ++pos_;
+        const QtPropertyList &children = property->getChildren();
+        int index = 0;
+        bool first = true;
+        while(nextElement(first))
+        {
+            bool ok = index < children.size() ? readProperty(children[index]) : skipValue();
+            if(!ok)
+            {
+                return false;
+            }
+            ++index;
+        }
+        return error_.isEmpty();
+    }
+
+    if(!expect('{'))
+    {
+        return false;
+    }
+
+    QString key;
+    bool first = true;
+    while(nextKey(key, first))
+    {
+        // keys are the names of direct children, as written by writeProperty.
+        QtProperty *child = property->findDirectChild(key);
+        bool ok = child != NULL ? readProperty(child) : skipValue();
+        if(!ok)
+        {
+            return false;
+        }
+    }
+    return error_.isEmpty();
+}
+
+bool QtJsonReader::readProperty(QtProperty *property)
+{
+    if(peek() == 'n')
+    {
+        return readLiteral("null");
+    }
+
+    QtDynamicItemProperty *item = dynamic_cast<QtDynamicItemProperty*>(property);
+    if(item != NULL)
+    {
+        return readProperty(item->getImpl());
+    }
+
+    QtDynamicListProperty *dynamicList = dynamic_cast<QtDynamicListProperty*>(property);
+    if(dynamicList != NULL)
+    {
+        return readDynamicList(dynamicList);
+    }
+
+    QtFloatListProperty *floatList = dynamic_cast<QtFloatListProperty*>(property);
+    if(floatList != NULL)
+    {
+        return readFloatList(floatList);
+    }
+
+    if(dynamic_cast<QtContainerProperty*>(property) != NULL)
+    {
+        return readChildren(property);
+    }
+
+    // scalars are assigned without going through QVariant.
+    char c = peek();
+    QtPropertyValue::Kind kind = property->getValueKind();
+    if(kind == QtPropertyValue::BOOL && (c == 't' || c == 'f'))
+    {
+        if(!readLiteral(c == 't' ? "true" : "false"))
+        {
+            return false;
+        }
+        property->setBoolValue(c == 't');
+        return true;
+    }
+    if((kind == QtPropertyValue::INT || kind == QtPropertyValue::DOUBLE) && (c == '-' || (c >= '0' && c <= '9')))
+    {
+        QVariant value;
+        if(!readNumber(value))
+        {
+            return false;
+        }
+        if(kind == QtPropertyValue::INT)
+        {
+            property->setIntValue(value.toLongLong());
+        }
+        else
+        {
+            property->setDoubleValue(value.toDouble());
+        }
+        return true;
+    }
+
+    QVariant value;
+    if(!readValue(value))
+    {
+        return false;
+    }
+    property->setValue(value);
+    return true;
+}
+
+bool QtJsonReader::readDocument(QtProperty *root)
+{
+    if(!readProperty(root))
+    {
+        return false;
+    }
+    if(peek() != 0)
+    {
+        return fail("garbage at the end of the document");
+    }
+    return true;
+}
+
+/********************************************************************/
+bool QtPropertyJson::write(const QtProperty *root, QIODevice *device, bool indented)
+{
+    QtJsonWriter writer(device, indented);
+    writer.writeProperty(root);
+    return writer.finish();
+}
+
+QByteArray QtPropertyJson::toJson(const QtProperty *root, bool indented)
+{
+    QtJsonWriter writer(NULL, indented);
+    writer.writeProperty(root);
+    writer.finish();
+    return writer.getBuffer();
+}
+
+bool QtPropertyJson::read(QtProperty *root, QIODevice *device, QString *error)
+{
+    QtJsonReader reader(device, QByteArray());
+    bool ok;
+    {
+        QtPropertyUpdateGuard guard(root);
+        ok = reader.readDocument(root);
+    }
+    if(!ok && error != NULL)
+    {
+        *error = reader.getError();
+    }
+    return ok;
+}
+
+bool QtPropertyJson::fromJson(QtProperty *root, const QByteArray &json, QString *error)
+{
+    QtJsonReader reader(NULL, json);
+    bool ok;
+    {
+        QtPropertyUpdateGuard guard(root);
+        ok = reader.readDocument(root);
+    }
+    if(!ok && error != NULL)
+    {
+        *error = reader.getError();
+    }
+    return ok;
+}
@@ -0,0 +1,38 @@
+﻿#ifndef QTPROPERTYJSON_H
+#define QTPROPERTYJSON_H
+
+#include "qtpropertyconfig.h"
+#include <QByteArray>
+#include <QString>
+
+class QIODevice;
+class QtProperty;
+
+/**
+ * @brief The QtPropertyJson class
+ *
+ * Streams the values of a property tree to and from JSON, without building
+ * the whole document as QVariant first.
+ *
+ * Groups and dicts are written as objects keyed by child name, lists, dynamic
+ * lists and float lists as arrays, colors as [r, g, b, a]. Other values are
+ * written as their QVariant.
+ *
+ * Importing walks the JSON text and the property tree together. Object keys
+ * are looked up with findChild, unknown keys and null values are skipped, and
+ * dynamic lists are resized to the length of their array. All values are
+ * applied in one batch update of the root, so each property notifies once.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyJson
+{
+public:
+    /** 把root的值写到device，数据分块写出。*/
+    static bool write(const QtProperty *root, QIODevice *device, bool indented = true);
+    static QByteArray toJson(const QtProperty *root, bool indented = true);
+
+    /** 从device分块读取JSON，并写入root的子孙属性。出错时，已经读到的值仍然生效。*/
+    static bool read(QtProperty *root, QIODevice *device, QString *error = NULL);
+    static bool fromJson(QtProperty *root, const QByteArray &json, QString *error = NULL);
+};
+
+#endif // QTPROPERTYJSON_H
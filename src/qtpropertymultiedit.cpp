@@ -0,0 +1,383 @@
+﻿#include "qtpropertymultiedit.h"
+#include "qtproperty.h"
+#include "qtpropertydelta.h"
+
+#include <QStringList>
+#include <QMetaObject>
+
+QtPropertyMultiEdit::QtPropertyMultiEdit(QtProperty *display, QObject *parent)
+    : QObject(parent)
+    , display_(display)
+    , syncing_(false)
+    , rebindPending_(false)
+{
+    listenTo(display_);
+    connect(display_->getNotifier(), SIGNAL(signalDestroyed(QtProperty*)), this, SLOT(onTargetDestroyed(QtProperty*)));
+}
+
+QtPropertyMultiEdit::~QtPropertyMultiEdit()
+{
+    foreach(const Binding &binding, bindings_)
+    {
+        if(binding.display != NULL)
+        {
+            binding.display->setMixed(false);
+        }
+    }
+
+    foreach(QtPropertyFactory *factory, factories_)
+    {
+        if(factory != NULL)
+        {
+            factory->removeListener(this);
+        }
+    }
+}
+
+void QtPropertyMultiEdit::listenTo(QtProperty *property)
+{
+    QtPropertyFactory *factory = property->getFactory();
+    if(factory != NULL && !factories_.contains(factory))
+    {
+        factories_.push_back(factory);
+        factory->addListener(this);
+    }
+}
+
+void QtPropertyMultiEdit::setTargets(const QList<QtProperty*> &targets)
+{
+    foreach(QtProperty *target, targets_)
+    {
+        disconnect(target->getNotifier(), SIGNAL(signalDestroyed(QtProperty*)), this, SLOT(onTargetDestroyed(QtProperty*)));
+    }
+    targets_.clear();
+    targetIndex_.clear();
+
+    foreach(QtProperty *target, targets)
+    {
+        if(target == NULL || targetIndex_.contains(target))
+        {
+            continue;
+        }
+        targetIndex_.insert(target, targets_.size());
+        targets_.push_back(target);
+        listenTo(target);
+        connect(target->getNotifier(), SIGNAL(signalDestroyed(QtProperty*)), this, SLOT(onTargetDestroyed(QtProperty*)));
+    }
+    rebind();
+}
+
+void QtPropertyMultiEdit::addTarget(QtProperty *target)
+{
+    QList<QtProperty*> targets = targets_.toList();
+    targets.push_back(target);
+    setTargets(targets);
+}
+
+void QtPropertyMultiEdit::removeTarget(QtProperty *target)
+{
+    QList<QtProperty*> targets = targets_.toList();
+    targets.removeAll(target);
+    setTargets(targets);
+}
+
+void QtPropertyMultiEdit::onTargetDestroyed(QtProperty *target)
+{
+    if(target == display_)
+    {
+        display_ = NULL;
+        bindings_.clear();
+        displayIndex_.clear();
+        pathIndex_.clear();
+        return;
+    }
+
+    targets_.removeAll(target);
+    targetIndex_.clear();
+    for(int i = 0; i < targets_.size(); ++i)
+    {
+        targetIndex_.insert(targets_[i], i);
+    }
+    rebind();
+}
+
+void QtPropertyMultiEdit::collectLeaves(QtProperty *property, const QString &path)
+{
+    const QtPropertyList &children = property->getChildren();
+    if(children.isEmpty())
+    {
+        if(property->hasValue())
+        {
+            Binding binding;
+            binding.display = property;
+            binding.path = path;
+            binding.differCount = 0;
+            displayIndex_.insert(property, bindings_.size());
+            pathIndex_.insert(path, bindings_.size());
+            bindings_.push_back(binding);
+        }
+        return;
+    }
+
+    QString prefix = path.isEmpty() ? path : path + '/';
+    foreach(QtProperty *child, children)
+    {
+        collectLeaves(child, prefix + child->getName());
+    }
+}
+
+void QtPropertyMultiEdit::rebind()
+{
+    rebindPending_ = false;
+    if(display_ == NULL)
+    {
+        return;
+    }
+
+    foreach(const Binding &binding, bindings_)
+    {
+        if(binding.display != NULL)
+        {
+            binding.display->setMixed(false);
+        }
+    }
+    bindings_.clear();
+    displayIndex_.clear();
+    pathIndex_.clear();
+
+    collectLeaves(display_, QString());
+
+    // the display takes the values of the first target.
+    syncing_ = true;
+    {
+        QtPropertyUpdateGuard guard(display_);
+        for(int i = 0; i < bindings_.size(); ++i)
+        {
+            Binding &binding = bindings_[i];
+            binding.targets.resize(targets_.size());
+            for(int k = 0; k < targets_.size(); ++k)
+            {
+                binding.targets[k] = targets_[k]->findByPath(binding.path);
+            }
+            compareAll(binding);
+            updateDisplay(binding);
+        }
+    }
+    syncing_ = false;
+}
+
+void QtPropertyMultiEdit::scheduleRebind(QtProperty *property)
+{
+    if(rebindPending_ || display_ == NULL)
+    {
+        return;
+    }
+
+    // a dynamic list edited on all targets inserts items N times, match once afterwards.
+    if(boundRootOf(property) != NULL)
+    {
+        rebindPending_ = true;
+        QMetaObject::invokeMethod(this, "rebind", Qt::QueuedConnection);
+    }
+}
+
+QtProperty* QtPropertyMultiEdit::boundRootOf(QtProperty *property) const
+{
+    for(; property != NULL; property = property->getParent())
+    {
+        if(property == display_ || targetIndex_.contains(property))
+        {
+            return property;
+        }
+    }
+    return NULL;
+}
+
+QString QtPropertyMultiEdit::pathOf(QtProperty *property, QtProperty *root) const
+{
+    QStringList names;
+    for(; property != root; property = property->getParent())
+    {
+        names.push_front(property->getName());
+    }
+    return names.join('/');
+}
+
+static bool sameValue(const QtProperty *a, const QtProperty *b)
+{
+    if(a == NULL || b == NULL)
+    {
+        return false;
+    }
+    if(a->getValueKind() != QtPropertyValue::VARIANT && a->getValueKind() == b->getValueKind())
+    {
+        return a->getScalarValue() == b->getScalarValue();
+    }
+    return QtValueEntry::capture(a, QString()).sameValue(QtValueEntry::capture(b, QString()));
+}
+
+void QtPropertyMultiEdit::compareTarget(Binding &binding, int index)
+{
+    bool differs = index > 0 && !sameValue(binding.targets[0], binding.targets[index]);
+    if(differs != binding.differs.testBit(index))
+    {
+        binding.differs.setBit(index, differs);
+        binding.differCount += differs ? 1 : -1;
+    }
+}
+
+void QtPropertyMultiEdit::compareAll(Binding &binding)
+{
+    binding.differs.fill(false, binding.targets.size());
+    binding.differCount = 0;
+    for(int k = 1; k < binding.targets.size(); ++k)
+    {
+        compareTarget(binding, k);
+    }
+}
+
+bool QtPropertyMultiEdit::hasMissingTarget(const Binding &binding) const
+{
+    foreach(const QtPropertyPointer &target, binding.targets)
+    {
+        if(target == NULL)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void QtPropertyMultiEdit::updateDisplay(Binding &binding)
+{
+    QtProperty *reference = binding.targets.isEmpty() ? NULL : binding.targets[0].data();
+    if(reference != NULL && !sameValue(reference, binding.display))
+    {
+        QtValueEntry::capture(reference, QString()).assignTo(binding.display);
+    }
+    binding.display->setMixed(reference == NULL || binding.differCount > 0);
+}
+
+void QtPropertyMultiEdit::fanOut(Binding &binding)
+{
+    QtValueEntry value = QtValueEntry::capture(binding.display, QString());
+
+    syncing_ = true;
+    foreach(QtProperty *target, targets_)
+    {
+        target->beginUpdate();
+    }
+    foreach(const QtPropertyPointer &target, binding.targets)
+    {
+        if(target != NULL)
+        {
+            value.assignTo(target);
+        }
+    }
+    foreach(QtProperty *target, targets_)
+    {
+        target->endUpdate();
+    }
+    syncing_ = false;
+
+    // a target missing the path keeps the row mixed.
+    compareAll(binding);
+    binding.display->setMixed(hasMissingTarget(binding) || binding.differCount > 0);
+}
+
+void QtPropertyMultiEdit::onPropertyValueChange(QtProperty *property)
+{
+    if(bindings_.isEmpty())
+    {
+        return;
+    }
+
+    QHash<QtProperty*, int>::const_iterator it = displayIndex_.constFind(property);
+    if(it != displayIndex_.constEnd())
+    {
+        // the display may be inside a batch, so the copy made by updateDisplay is
+        // notified later. A value equal to the first target needs no fan out.
+        Binding &binding = bindings_[*it];
+        QtProperty *reference = binding.targets.isEmpty() ? NULL : binding.targets[0].data();
+        if(!syncing_ && !sameValue(reference, property))
+        {
+            fanOut(binding);
+        }
+        return;
+    }
+
+    if(syncing_)
+    {
+        return;
+    }
+
+    QtProperty *root = boundRootOf(property);
+    int target = root != NULL ? targetIndex_.value(root, -1) : -1;
+    if(target < 0)
+    {
+        return;
+    }
+
+    int index = pathIndex_.value(pathOf(property, root), -1);
+    if(index < 0)
+    {
+        return;
+    }
+
+    Binding &binding = bindings_[index];
+    if(binding.targets[target] != property)
+    {
+        return;
+    }
+
+    if(target == 0)
+    {
+        compareAll(binding);
+    }
+    else
+    {
+        compareTarget(binding, target);
+    }
+
+    updateDisplay(binding);
+}
+
+void QtPropertyMultiEdit::onPropertyInsert(QtProperty *property, QtProperty * /*parent*/)
+{
+    scheduleRebind(property);
+}
+
+void QtPropertyMultiEdit::onPropertyRemove(QtProperty * /*property*/, QtProperty *parent)
+{
+    // bound properties of the removed subtree are tracked by QtPropertyPointer.
+    if(parent != NULL)
+    {
+        scheduleRebind(parent);
+    }
+}
+
+void QtPropertyMultiEdit::onChildrenInsert(QtProperty *parent, int /*first*/, int /*last*/)
+{
+    scheduleRebind(parent);
+}
+
+bool QtPropertyMultiEdit::isChildrenInUse(QtProperty *property)
+{
+    // bound leaves live inside the display and the targets.
+    if(boundRootOf(property) != NULL)
+    {
+        return true;
+    }
+    if(display_ != NULL && display_->isInSubtreeOf(property))
+    {
+        return true;
+    }
+    foreach(QtProperty *target, targets_)
+    {
+        if(target->isInSubtreeOf(property))
+        {
+            return true;
+        }
+    }
+    return false;
+}
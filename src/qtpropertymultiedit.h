@@ -0,0 +1,92 @@
+﻿#ifndef QTPROPERTYMULTIEDIT_H
+#define QTPROPERTYMULTIEDIT_H
+
+#include "qtpropertyconfig.h"
+#include "qtpropertyfactory.h"
+#include "qtproperty.h"
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+#include <QHash>
+#include <QBitArray>
+
+/**
+ * @brief The QtPropertyMultiEdit class
+ *
+ * Binds one display tree, shown by any browser, to N target trees of the
+ * same structure. Leaves are matched by path when binding.
+ *
+ * Each display leaf shows the value of the first target and is marked mixed
+ * (QtProperty::setMixed) while any other target differs. For every leaf a bit
+ * per target records whether it differs from the first one, so a change of
+ * one target costs one comparison; only a change of the first target
+ * compares the whole row again.
+ *
+ * Editing a display leaf writes the value to all targets, with every target
+ * tree inside one batch update.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyMultiEdit : public QObject, public QtPropertyListener
+{
+    Q_OBJECT
+public:
+    explicit QtPropertyMultiEdit(QtProperty *display, QObject *parent = NULL);
+    ~QtPropertyMultiEdit();
+
+    QtProperty* getDisplay() const { return display_; }
+
+    void setTargets(const QList<QtProperty*> &targets);
+    void addTarget(QtProperty *target);
+    void removeTarget(QtProperty *target);
+    const QVector<QtProperty*>& getTargets() const { return targets_; }
+
+    virtual void onPropertyInsert(QtProperty *property, QtProperty *parent);
+    virtual void onPropertyRemove(QtProperty *property, QtProperty *parent);
+    virtual void onPropertyValueChange(QtProperty *property);
+    virtual void onChildrenInsert(QtProperty *parent, int first, int last);
+    virtual bool isChildrenInUse(QtProperty *property);
+
+public slots:
+    /** 重新按路径匹配所有属性。属性树结构变化后会自动延迟调用。*/
+    void rebind();
+
+private slots:
+    void onTargetDestroyed(QtProperty *property);
+
+private:
+    struct Binding
+    {
+        QtPropertyPointer       display;
+        QString                 path;
+        QVector<QtPropertyPointer> targets;     ///< 缺少该路径的对象为NULL
+        QBitArray               differs;    ///< 与第一个对象的值不同
+        int                     differCount;
+    };
+
+    void listenTo(QtProperty *property);
+    void collectLeaves(QtProperty *property, const QString &path);
+    void scheduleRebind(QtProperty *property);
+
+    /** 包含property的display或target，可以是子树。都不包含时返回NULL。*/
+    QtProperty* boundRootOf(QtProperty *property) const;
+    QString pathOf(QtProperty *property, QtProperty *root) const;
+    bool hasMissingTarget(const Binding &binding) const;
+
+    void compareTarget(Binding &binding, int index);
+    void compareAll(Binding &binding);
+    void updateDisplay(Binding &binding);
+    void fanOut(Binding &binding);
+
+    QtProperty*             display_;
+    QVector<QtProperty*>    targets_;
+    QHash<QtProperty*, int> targetIndex_;
+
+    QVector<Binding>        bindings_;
+    QHash<QtProperty*, int> displayIndex_;
+    QHash<QString, int>     pathIndex_;
+
+    QList< QPointer<QtPropertyFactory> > factories_;
+    bool                    syncing_;
+    bool                    rebindPending_;
+};
+
+#endif // QTPROPERTYMULTIEDIT_H
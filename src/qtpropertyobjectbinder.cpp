@@ -0,0 +1,508 @@
+﻿#include "qtpropertyobjectbinder.h"
+#include "qtproperty.h"
+#include "qtpropertyfactory.h"
+#include "qtpropertyschema.h"
+#include "qtpropertytype.h"
+#include "qtattributename.h"
+
+#include <QMetaObject>
+#include <QMetaProperty>
+#include <QMetaEnum>
+#include <QStringList>
+#include <QColor>
+
+/** 一个类的所有可绑定属性，以及编译好的schema。*/
+struct QtMetaClassInfo
+{
+    struct Entry
+    {
+        QMetaProperty           property;
+        QString                 path;
+        QtPropertyType::Type    type;
+        QVector<int>            keyValues;  ///< enum和flag每个选项的值
+    };
+
+    QtPropertySchema            schema;
+    QVector<Entry>              entries;
+    QHash<int, QVector<int> >   notifiers;  ///< NOTIFY信号的方法序号到条目
+};
+
+namespace
+{
+    typedef QHash<const QMetaObject*, QtMetaClassInfo*> ClassCache;
+
+    /** 类信息只依赖QMetaObject，所有binder共享，不释放。*/
+    ClassCache& classCache()
+    {
+        static ClassCache cache;
+        return cache;
+    }
+
+    QtPropertyType::Type mapType(const QMetaProperty &property)
+    {
+        if(property.isFlagType())
+        {
+            return QtPropertyType::FLAG;
+        }
+        if(property.isEnumType())
+        {
+            return QtPropertyType::ENUM;
+        }
+
+        int type = property.userType();
+        switch(type)
+        {
+        case QMetaType::Bool:
+            return QtPropertyType::BOOL;
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Long:
+        case QMetaType::ULong:
+        case QMetaType::Short:
+        case QMetaType::UShort:
+        case QMetaType::Char:
+        case QMetaType::SChar:
+        case QMetaType::UChar:
+            return QtPropertyType::INT;
+        case QMetaType::Double:
+        case QMetaType::Float:
+            return QtPropertyType::FLOAT;
+        case QMetaType::QString:
+        case QMetaType::QByteArray:
+            return QtPropertyType::STRING;
+        case QMetaType::QColor:
+            return QtPropertyType::COLOR;
+        default:
+            break;
+        }
+
+        if(type == qMetaTypeId<QVector<float> >())
+        {
+            return QtPropertyType::FLOAT_LIST;
+        }
+        return QtPropertyType::NONE;
+    }
+}
+
+const QtMetaClassInfo* QtPropertyObjectBinder::classInfo(const QMetaObject *metaObject)
+{
+    QtMetaClassInfo *&info = classCache()[metaObject];
+    if(info != NULL)
+    {
+        return info;
+    }
+
+    info = new QtMetaClassInfo();
+
+    // base classes first, as in the designer.
+    QVector<const QMetaObject*> classes;
+    for(const QMetaObject *mo = metaObject; mo != NULL; mo = mo->superClass())
+    {
+        classes.push_front(mo);
+    }
+
+    QVariantList groups;
+    foreach(const QMetaObject *mo, classes)
+    {
+        QString className = mo->className();
+        QVariantList children;
+        for(int i = mo->propertyOffset(); i < mo->propertyCount(); ++i)
+        {
+            QMetaProperty property = mo->property(i);
+            QtPropertyType::Type type = mapType(property);
+            if(type == QtPropertyType::NONE || !property.isReadable() || !property.isDesignable())
+            {
+                continue;
+            }
+
+            QtMetaClassInfo::Entry entry;
+            entry.property = property;
+            entry.path = className + '/' + property.name();
+            entry.type = type;
+
+            QVariantMap attributes;
+            if(type == QtPropertyType::ENUM || type == QtPropertyType::FLAG)
+            {
+                QMetaEnum metaEnum = property.enumerator();
+                QStringList keys;
+                for(int k = 0; k < metaEnum.keyCount(); ++k)
+                {
+                    // a flag without bits can not be toggled.
+                    if(type == QtPropertyType::FLAG && metaEnum.value(k) == 0)
+                    {
+                        continue;
+                    }
+                    keys.push_back(metaEnum.key(k));
+                    entry.keyValues.push_back(metaEnum.value(k));
+                }
+                attributes.insert(type == QtPropertyType::ENUM ? QtAttributeName::EnumName : QtAttributeName::FlagName, keys);
+            }
+            if(!property.isWritable())
+            {
+                attributes.insert(QtAttributeName::ReadOnly, true);
+            }
+
+            QVariantMap node;
+            node.insert("type", QtPropertyType::typeName(type));
+            node.insert("name", QString(property.name()));
+            node.insert("title", QString(property.name()));
+            if(!attributes.isEmpty())
+            {
+                node.insert("attributes", attributes);
+            }
+            children.push_back(node);
+
+            if(property.hasNotifySignal())
+            {
+                info->notifiers[property.notifySignalIndex()].push_back(info->entries.size());
+            }
+            info->entries.push_back(entry);
+        }
+
+        if(!children.isEmpty())
+        {
+            QVariantMap group;
+            group.insert("type", QtPropertyType::typeName(QtPropertyType::GROUP));
+            group.insert("name", className);
+            group.insert("title", className);
+            group.insert("children", children);
+            groups.push_back(group);
+        }
+    }
+
+    QVariantMap root;
+    root.insert("type", QtPropertyType::typeName(QtPropertyType::GROUP));
+    root.insert("name", QString(metaObject->className()));
+    root.insert("children", groups);
+    info->schema = QtPropertySchema::compile(root);
+    return info;
+}
+
+/********************************************************************/
+QtPropertyObjectBinder::QtPropertyObjectBinder(QtPropertyFactory *factory, QObject *parent)
+    : QObject(parent)
+    , factory_(factory)
+    , nextId_(0)
+    , updating_(false)
+{
+    factory_->addListener(this);
+}
+
+QtPropertyObjectBinder::~QtPropertyObjectBinder()
+{
+    foreach(QtProperty *root, roots_.keys())
+    {
+        unbind(root);
+    }
+
+    if(factory_ != NULL)
+    {
+        factory_->removeListener(this);
+    }
+}
+
+QtProperty* QtPropertyObjectBinder::bind(QObject *object)
+{
+    const QtMetaClassInfo *info = classInfo(object->metaObject());
+    if(factory_ == NULL || info->entries.isEmpty() || !info->schema.isValid())
+    {
+        return NULL;
+    }
+
+    QtProperty *root = factory_->createProperty(info->schema);
+
+    int id = nextId_++;
+    Binding &binding = bindings_[id];
+    binding.object = object;
+    binding.root = root;
+    binding.info = info;
+    binding.leaves.resize(info->entries.size());
+
+    updating_ = true;
+    for(int i = 0; i < info->entries.size(); ++i)
+    {
+        QtProperty *leaf = root->findByPath(info->entries[i].path);
+        binding.leaves[i] = leaf;
+        if(leaf != NULL)
+        {
+            leaves_.insert(leaf, qMakePair(id, i));
+            readValue(binding, i);
+        }
+    }
+    updating_ = false;
+
+    roots_.insert(root, id);
+    connect(root->getNotifier(), SIGNAL(signalDestroyed(QtProperty*)), this, SLOT(onRootDestroyed(QtProperty*)));
+
+    if(!objects_.contains(object))
+    {
+        int slot = staticMetaObject.indexOfSlot("onObjectNotify()");
+        for(QHash<int, QVector<int> >::const_iterator it = info->notifiers.constBegin(); it != info->notifiers.constEnd(); ++it)
+        {
+            QMetaObject::connect(object, it.key(), this, slot, Qt::UniqueConnection);
+        }
+        connect(object, SIGNAL(destroyed(QObject*)), this, SLOT(onObjectDestroyed(QObject*)));
+    }
+    objects_.insert(object, id);
+    return root;
+}
+
+void QtPropertyObjectBinder::unbind(QtProperty *root)
+{
+    int id = roots_.value(root, -1);
+    if(id < 0)
+    {
+        return;
+    }
+
+    disconnect(root->getNotifier(), SIGNAL(signalDestroyed(QtProperty*)), this, SLOT(onRootDestroyed(QtProperty*)));
+    removeBinding(id);
+}
+
+void QtPropertyObjectBinder::removeBinding(int id)
+{
+    QHash<int, Binding>::iterator it = bindings_.find(id);
+    if(it == bindings_.end())
+    {
+        return;
+    }
+
+    // the tree may be destroyed already, its pointers are used as keys only.
+    Binding binding = *it;
+    bindings_.erase(it);
+    roots_.remove(binding.root);
+    foreach(QtProperty *leaf, binding.leaves)
+    {
+        leaves_.remove(leaf);
+    }
+
+    QObject *object = binding.object;
+    if(object != NULL)
+    {
+        objects_.remove(object, id);
+        if(!objects_.contains(object))
+        {
+            disconnect(object, 0, this, 0);
+        }
+    }
+}
+
+QObject* QtPropertyObjectBinder::getObject(QtProperty *root) const
+{
+    int id = roots_.value(root, -1);
+    return id >= 0 ? bindings_.value(id).object.data() : NULL;
+}
+
+void QtPropertyObjectBinder::refresh(QtProperty *root)
+{
+    int id = roots_.value(root, -1);
+    if(id < 0)
+    {
+        return;
+    }
+
+    Binding &binding = bindings_[id];
+    QtPropertyUpdateGuard guard(binding.root);
+    for(int i = 0; i < binding.leaves.size(); ++i)
+    {
+        readValue(binding, i);
+    }
+}
+
+void QtPropertyObjectBinder::readValue(Binding &binding, int entry)
+{
+    QtProperty *leaf = binding.leaves[entry];
+    if(leaf == NULL || binding.object == NULL)
+    {
+        return;
+    }
+
+    const QtMetaClassInfo::Entry &info = binding.info->entries[entry];
+    QVariant value = info.property.read(binding.object);
+
+    bool updating = updating_;
+    updating_ = true;
+    switch(info.type)
+    {
+    case QtPropertyType::ENUM:
+        leaf->setIntValue(info.keyValues.indexOf(value.toInt()));
+        break;
+    case QtPropertyType::FLAG:
+    {
+        int bits = value.toInt();
+        qint64 mask = 0;
+        for(int k = 0; k < info.keyValues.size(); ++k)
+        {
+            if((bits & info.keyValues[k]) == info.keyValues[k])
+            {
+                mask |= qint64(1) << k;
+            }
+        }
+        leaf->setIntValue(mask);
+        break;
+    }
+    case QtPropertyType::BOOL:
+        leaf->setBoolValue(value.toBool());
+        break;
+    case QtPropertyType::INT:
+        leaf->setIntValue(value.toLongLong());
+        break;
+    case QtPropertyType::FLOAT:
+        leaf->setDoubleValue(value.toDouble());
+        break;
+    case QtPropertyType::COLOR:
+        leaf->setColorValue(value.value<QColor>());
+        break;
+    case QtPropertyType::STRING:
+        leaf->setValue(value.toString());
+        break;
+    default:
+        leaf->setValue(value);
+        break;
+    }
+    updating_ = updating;
+}
+
+static QVariant propertyToMeta(const QtMetaClassInfo::Entry &info, QtProperty *leaf)
+{
+    switch(info.type)
+    {
+    case QtPropertyType::ENUM:
+        return info.keyValues.value(leaf->getIntValue(), 0);
+    case QtPropertyType::FLAG:
+    {
+        qint64 mask = leaf->getIntValue();
+        int bits = 0;
+        for(int k = 0; k < info.keyValues.size(); ++k)
+        {
+            if(mask & (qint64(1) << k))
+            {
+                bits |= info.keyValues[k];
+            }
+        }
+        return bits;
+    }
+    case QtPropertyType::BOOL:
+        return leaf->getBoolValue();
+    case QtPropertyType::INT:
+        return leaf->getIntValue();
+    case QtPropertyType::FLOAT:
+        return leaf->getDoubleValue();
+    case QtPropertyType::COLOR:
+        return leaf->getColorValue();
+    case QtPropertyType::FLOAT_LIST:
+    {
+        QtFloatListProperty *floatList = dynamic_cast<QtFloatListProperty*>(leaf);
+        if(floatList != NULL)
+        {
+            return QVariant::fromValue(floatList->getValues());
+        }
+        return leaf->getValue();
+    }
+    default:
+        return leaf->getValue();
+    }
+}
+
+bool QtPropertyObjectBinder::isChildrenInUse(QtProperty *property)
+{
+    for(QHash<QtProperty*, int>::const_iterator it = roots_.constBegin(); it != roots_.constEnd(); ++it)
+    {
+        if(property->isInSubtreeOf(it.key()) || it.key()->isInSubtreeOf(property))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool sameMetaValue(const QtMetaClassInfo::Entry &info, const QVariant &a, const QVariant &b)
+{
+    // enums are read as their own type, compare the numbers.
+    if(info.type == QtPropertyType::ENUM || info.type == QtPropertyType::FLAG)
+    {
+        return a.toInt() == b.toInt();
+    }
+    return a == b;
+}
+
+void QtPropertyObjectBinder::onPropertyValueChange(QtProperty *property)
+{
+    // every property of the factory is reported here, most are not bound.
+    if(updating_ || leaves_.isEmpty())
+    {
+        return;
+    }
+
+    QHash<QtProperty*, QPair<int, int> >::const_iterator it = leaves_.constFind(property);
+    if(it == leaves_.constEnd())
+    {
+        return;
+    }
+
+    Binding &binding = bindings_[it->first];
+    int entry = it->second;
+    if(binding.object == NULL)
+    {
+        return;
+    }
+
+    const QtMetaClassInfo::Entry &info = binding.info->entries[entry];
+    if(info.type == QtPropertyType::ENUM &&
+       (property->getIntValue() < 0 || property->getIntValue() >= info.keyValues.size()))
+    {
+        // an enum value without a key, nothing was picked.
+        return;
+    }
+
+    // values read by refresh or a NOTIFY signal inside a batch arrive here
+    // after updating_ is reset, they equal the object and are not written back.
+    QVariant value = propertyToMeta(info, property);
+    if(sameMetaValue(info, value, info.property.read(binding.object)))
+    {
+        return;
+    }
+
+    updating_ = true;
+    info.property.write(binding.object, value);
+    updating_ = false;
+
+    // the object may have adjusted the value.
+    readValue(binding, entry);
+}
+
+void QtPropertyObjectBinder::onObjectNotify()
+{
+    QObject *object = sender();
+    int signal = senderSignalIndex();
+
+    foreach(int id, objects_.values(object))
+    {
+        Binding &binding = bindings_[id];
+        QVector<int> entries = binding.info->notifiers.value(signal);
+        foreach(int entry, entries)
+        {
+            readValue(binding, entry);
+        }
+    }
+}
+
+void QtPropertyObjectBinder::onObjectDestroyed(QObject *object)
+{
+    // the trees stay, they are no longer connected to anything.
+    foreach(int id, objects_.values(object))
+    {
+        removeBinding(id);
+    }
+}
+
+void QtPropertyObjectBinder::onRootDestroyed(QtProperty *root)
+{
+    int id = roots_.value(root, -1);
+    if(id >= 0)
+    {
+        removeBinding(id);
+    }
+}
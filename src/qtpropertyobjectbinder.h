@@ -0,0 +1,84 @@
+﻿#ifndef QTPROPERTYOBJECTBINDER_H
+#define QTPROPERTYOBJECTBINDER_H
+
+#include "qtpropertyconfig.h"
+#include "qtpropertyfactory.h"
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+#include <QHash>
+
+class QtProperty;
+struct QtMetaClassInfo;
+
+/**
+ * @brief The QtPropertyObjectBinder class
+ *
+ * Builds property trees from the Q_PROPERTY list of QObjects and keeps them
+ * in sync with the objects.
+ *
+ * Every class in the inheritance chain becomes a group holding its own
+ * designable, readable properties. Bool, integer, floating point, string,
+ * color and QVector<float> properties map to the matching property types,
+ * enums to ENUM and flags to FLAG with the keys of their QMetaEnum. Other
+ * types are skipped, and properties without a WRITE are read-only.
+ *
+ * The schema of each QMetaObject is compiled once and cached for all binders,
+ * so binding another instance of the same class clones the factory's
+ * prototype tree. Edits are written back with QMetaProperty::write, and NOTIFY
+ * signals refresh the properties they belong to. Edits are received as a
+ * listener of the factory, the leaves are not connected one by one.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyObjectBinder : public QObject, public QtPropertyListener
+{
+    Q_OBJECT
+public:
+    explicit QtPropertyObjectBinder(QtPropertyFactory *factory, QObject *parent = NULL);
+    ~QtPropertyObjectBinder();
+
+    /** 为object创建属性树并绑定。调用者负责delete返回的属性树，没有可显示的属性时返回NULL。*/
+    QtProperty* bind(QObject *object);
+
+    /** 解除绑定，属性树保留。*/
+    void unbind(QtProperty *root);
+
+    QObject* getObject(QtProperty *root) const;
+
+    /** 重新读取object所有属性的值。*/
+    void refresh(QtProperty *root);
+
+    virtual void onPropertyValueChange(QtProperty *property);
+    virtual bool isChildrenInUse(QtProperty *property);
+
+private slots:
+    void onObjectNotify();
+    void onObjectDestroyed(QObject *object);
+    void onRootDestroyed(QtProperty *root);
+
+private:
+    struct Binding
+    {
+        QPointer<QObject>       object;
+        QtProperty*             root;
+        const QtMetaClassInfo*  info;
+        QVector<QtProperty*>    leaves;     ///< 与info的entries一一对应
+    };
+
+    /** 已缓存的类信息，第一次使用时编译。*/
+    static const QtMetaClassInfo* classInfo(const QMetaObject *metaObject);
+
+    void readValue(Binding &binding, int entry);
+    void removeBinding(int id);
+
+    QPointer<QtPropertyFactory> factory_;
+    QHash<int, Binding>     bindings_;
+    int                     nextId_;
+    QHash<QtProperty*, int> roots_;
+    QMultiHash<QObject*, int> objects_;
+
+    /** 属性到(绑定, 条目)的映射。*/
+    QHash<QtProperty*, QPair<int, int> > leaves_;
+    bool                    updating_;
+};
+
+#endif // QTPROPERTYOBJECTBINDER_H
@@ -0,0 +1,341 @@
+﻿#include "qtpropertyschema.h"
+#include "qtproperty.h"
+#include "qtpropertyfactory.h"
+#include "qtpropertydefinition.h"
+#include "qtpropertyvalue.h"
+#include "qtpropertytype.h"
+#include "qtpropertybrowserutils.h"
+
+#include <QPointer>
+
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QAtomicInt>
+
+namespace
+{
+    /** 前序排列的节点。definition不含子定义，childCount个子节点紧随其后。*/
+    struct Instruction
+    {
+        QtPropertyDefinition    definition;
+        int                     childCount;
+    };
+
+    struct BuildFrame
+    {
+        QtProperty*             property;
+        const Instruction*      instruction;
+        int                     remaining;
+    };
+
+    QAtomicInt nextSchemaId(1);
+}
+
+class QtPropertySchemaData : public QSharedData
+{
+public:
+    QtPropertySchemaData()
+        : id(0)
+    {}
+
+    // a detached copy builds its own prototypes.
+    QtPropertySchemaData(const QtPropertySchemaData &other)
+        : QSharedData(other)
+        , id(other.id)
+        , instructions(other.instructions)
+    {}
+
+    ~QtPropertySchemaData()
+    {
+        foreach(const Prototype &prototype, prototypes)
+        {
+            prototype.tree->destroy();
+        }
+    }
+
+    struct Prototype
+    {
+        QPointer<QtPropertyFactory> factory;
+        QtProperty*                 tree;
+    };
+
+    int                     id;
+    QVector<Instruction>    instructions;
+    QVector<Prototype>      prototypes;
+};
+
+static bool compileNode(const QVariant &node, QVector<Instruction> &instructions, QString *error)
+{
+    if(node.type() != QVariant::Map)
+    {
+        *error = "schema node is not an object";
+        return false;
+    }
+
+    QVariantMap map = node.toMap();
+    QString typeName = map.value("type").toString();
+    if(typeName.isEmpty())
+    {
+        *error = QString("schema node '%1' has no type").arg(map.value("name").toString());
+        return false;
+    }
+
+    // unknown names are typos, registering them would create properties nobody can edit.
+    QtPropertyType::Type type = QtPropertyType::findType(typeName);
+    if(type == QtPropertyType::NONE)
+    {
+        *error = QString("schema node '%1' has unknown type '%2'").arg(map.value("name").toString(), typeName);
+        return false;
+    }
+
+    QtPropertyDefinition definition(type, map.value("name").toString());
+    definition.setTitle(map.value("title").toString());
+    definition.setToolTip(map.value("tips").toString());
+    if(map.contains("bgColor"))
+    {
+        definition.setBackgroundColor(QtPropertyBrowserUtils::variant2color(map.value("bgColor")));
+    }
+
+    QVariantMap attributes = map.value("attributes").toMap();
+    for(QVariantMap::const_iterator it = attributes.constBegin(); it != attributes.constEnd(); ++it)
+    {
+        definition.setAttribute(it.key(), it.value());
+    }
+    definition.setDefaultValue(map.value("default"));
+
+    QVariant children = map.value("children");
+    if(children.isValid() && children.type() != QVariant::List)
+    {
+        *error = QString("children of '%1' is not an array").arg(definition.getName());
+        return false;
+    }
+
+    QVariantList childList = children.toList();
+    Instruction instruction;
+    instruction.definition = definition;
+    instruction.childCount = childList.size();
+    instructions.push_back(instruction);
+
+    foreach(const QVariant &child, childList)
+    {
+        if(!compileNode(child, instructions, error))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/********************************************************************/
+QtPropertySchema::QtPropertySchema()
+    : d(new QtPropertySchemaData())
+{
+
+}
+
+QtPropertySchema::QtPropertySchema(const QtPropertySchema &other)
+    : d(other.d)
+{
+
+}
+
+QtPropertySchema& QtPropertySchema::operator=(const QtPropertySchema &other)
+{
+    d = other.d;
+    return *this;
+}
+
+QtPropertySchema::~QtPropertySchema()
+{
+
+}
+
+QtPropertySchema QtPropertySchema::compile(const QVariant &schema, QString *error)
+{
+    QString message;
+    QVariant root = schema;
+    if(root.type() == QVariant::List)
+    {
+        QVariantMap group;
+        group.insert("type", QtPropertyType::typeName(QtPropertyType::GROUP));
+        group.insert("children", root);
+        root = group;
+    }
+
+    QtPropertySchema ret;
+    if(!compileNode(root, ret.d->instructions, &message))
+    {
+        if(error != NULL)
+        {
+            *error = message;
+        }
+        return QtPropertySchema();
+    }
+
+    ret.d->instructions.squeeze();
+    ret.d->id = nextSchemaId.fetchAndAddRelaxed(1);
+    return ret;
+}
+
+QtPropertySchema QtPropertySchema::fromJson(const QByteArray &json, QString *error)
+{
+    QJsonParseError result;
+    QJsonDocument doc = QJsonDocument::fromJson(json, &result);
+    if(doc.isNull())
+    {
+        if(error != NULL)
+        {
+            *error = result.errorString();
+        }
+        return QtPropertySchema();
+    }
+    return compile(doc.toVariant(), error);
+}
+
+namespace
+{
+    struct FileCacheEntry
+    {
+        QDateTime           modified;
+        QtPropertySchema    schema;
+    };
+
+    typedef QHash<QString, FileCacheEntry> FileCache;
+
+    FileCache& fileCache()
+    {
+        static FileCache cache;
+        return cache;
+    }
+}
+
+QtPropertySchema QtPropertySchema::fromFile(const QString &path, QString *error)
+{
+    QFileInfo info(path);
+    QString key = info.absoluteFilePath();
+    QDateTime modified = info.lastModified();
+
+    FileCache::const_iterator it = fileCache().constFind(key);
+    if(it != fileCache().constEnd() && it->modified == modified)
+    {
+        return it->schema;
+    }
+
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        if(error != NULL)
+        {
+            *error = file.errorString();
+        }
+        return QtPropertySchema();
+    }
+
+    QtPropertySchema schema = fromJson(file.readAll(), error);
+    if(schema.isValid())
+    {
+        // the old schema, and the prototypes built from it, go with its last copy.
+        FileCacheEntry &entry = fileCache()[key];
+        entry.modified = modified;
+        entry.schema = schema;
+    }
+    return schema;
+}
+
+void QtPropertySchema::clearFileCache()
+{
+    fileCache().clear();
+}
+
+bool QtPropertySchema::isValid() const
+{
+    return !d->instructions.empty();
+}
+
+int QtPropertySchema::getId() const
+{
+    return d->id;
+}
+
+QtProperty* QtPropertySchema::getPrototype(QtPropertyFactory *factory) const
+{
+    if(!isValid())
+    {
+        return NULL;
+    }
+
+    // the cache does not change the schema, so the shared data is not detached.
+    QVector<QtPropertySchemaData::Prototype> &prototypes = const_cast<QtPropertySchemaData*>(d.constData())->prototypes;
+    for(int i = prototypes.size() - 1; i >= 0; --i)
+    {
+        if(prototypes[i].factory == factory)
+        {
+            return prototypes[i].tree;
+        }
+        if(prototypes[i].factory == NULL)
+        {
+            // the factory is gone, nobody asks for its prototype again.
+            prototypes[i].tree->destroy();
+            prototypes.remove(i);
+        }
+    }
+
+    QtPropertySchemaData::Prototype prototype;
+    prototype.factory = factory;
+    prototype.tree = build(factory);
+    prototypes.push_back(prototype);
+    return prototype.tree;
+}
+
+QtProperty* QtPropertySchema::build(QtPropertyFactory *factory) const
+{
+    if(!isValid())
+    {
+        return NULL;
+    }
+
+    // the tree is built without recursion, a frame waits for its remaining children.
+    QtProperty *root = NULL;
+    QVector<BuildFrame> stack;
+
+    const QVector<Instruction> &instructions = d->instructions;
+    for(int i = 0; i < instructions.size(); ++i)
+    {
+        const Instruction &instruction = instructions[i];
+        QtProperty *property = factory->createProperty(instruction.definition.getType());
+        property->setDefinition(instruction.definition);
+
+        if(stack.empty())
+        {
+            root = property;
+        }
+        else
+        {
+            stack.back().property->addChild(property);
+            --stack.back().remaining;
+        }
+
+        BuildFrame frame;
+        frame.property = property;
+        frame.instruction = &instruction;
+        frame.remaining = instruction.childCount;
+        stack.push_back(frame);
+
+        // a finished node gets its default value, after its children, like createProperty does.
+        while(!stack.empty() && stack.back().remaining == 0)
+        {
+            const BuildFrame &done = stack.back();
+            const QVariant &value = done.instruction->definition.getDefaultValue();
+            if(value.isValid())
+            {
+                done.property->setValue(value);
+            }
+            stack.pop_back();
+        }
+    }
+    return root;
+}
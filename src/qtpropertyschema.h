@@ -0,0 +1,73 @@
+﻿#ifndef QTPROPERTYSCHEMA_H
+#define QTPROPERTYSCHEMA_H
+
+#include "qtpropertyconfig.h"
+#include <QSharedDataPointer>
+#include <QVariant>
+#include <QString>
+
+class QtProperty;
+class QtPropertyFactory;
+class QtPropertySchemaData;
+
+/**
+ * @brief The QtPropertySchema class
+ *
+ * A property tree described by a declarative schema, compiled once into a
+ * flat instruction list. Each node of the schema is a JSON object:
+ *
+ *   {
+ *     "type": "group", "name": "information", "title": "Information",
+ *     "tips": "...", "bgColor": "#ffe0e0",
+ *     "attributes": { "minValue": 0 },
+ *     "default": 18,
+ *     "children": [ ... ]
+ *   }
+ *
+ * Only "type" is required. The root may also be an array, it is then loaded
+ * as the children of an unnamed group.
+ *
+ * Every instruction holds a shared QtPropertyDefinition, so building a tree
+ * never parses or applies attributes again. QtPropertyFactory::createProperty
+ * builds the tree once per factory and clones it afterwards. The prototype
+ * trees belong to the shared data and are destroyed with the last copy.
+ *
+ * A schema is implicitly shared and immutable after compiling.
+ */
+class QTPROPERTYSHEET_DLL QtPropertySchema
+{
+public:
+    /** 构造空的schema。*/
+    QtPropertySchema();
+    QtPropertySchema(const QtPropertySchema &other);
+    QtPropertySchema& operator=(const QtPropertySchema &other);
+    ~QtPropertySchema();
+
+    /** 编译已经解析的schema，如QJsonDocument::toVariant的结果。失败时返回空schema。*/
+    static QtPropertySchema compile(const QVariant &schema, QString *error = NULL);
+
+    /** 解析并编译JSON文本。*/
+    static QtPropertySchema fromJson(const QByteArray &json, QString *error = NULL);
+
+    /** 加载schema文件。编译结果按路径缓存，文件修改后重新编译。*/
+    static QtPropertySchema fromFile(const QString &path, QString *error = NULL);
+    static void clearFileCache();
+
+    bool isValid() const;
+
+    /** 每次编译得到唯一的id，复制的schema共享同一个id。*/
+    int getId() const;
+
+    /** 执行指令列表创建属性树。通常应使用QtPropertyFactory::createProperty，它会缓存结果。*/
+    QtProperty* build(QtPropertyFactory *factory) const;
+
+    /** factory为这个schema生成的原型，第一次调用时创建。
+     *  原型保存在共享数据中，随schema的最后一个副本一起释放。
+     */
+    QtProperty* getPrototype(QtPropertyFactory *factory) const;
+
+private:
+    QSharedDataPointer<QtPropertySchemaData> d;
+};
+
+#endif // QTPROPERTYSCHEMA_H
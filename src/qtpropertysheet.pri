@@ -13,7 +13,20 @@ SOURCES += \
     $$PWD/qtpropertyfactory.cpp \
     $$PWD/qtpropertytype.cpp \
     $$PWD/qtbuttonpropertybrowser.cpp \
-    $$PWD/qtbuttonpropertyitem.cpp
+    $$PWD/qtbuttonpropertyitem.cpp \
+    $$PWD/qtpropertyattributes.cpp \
+    $$PWD/qtpropertydefinition.cpp \
+    $$PWD/qtpropertyarena.cpp \
+    $$PWD/qtpropertyvalue.cpp \
+    $$PWD/qtpropertyschema.cpp \
+    $$PWD/qtpropertysnapshot.cpp \
+    $$PWD/qtpropertyjson.cpp \
+    $$PWD/qtpropertydelta.cpp \
+    $$PWD/qtpropertyundo.cpp \
+    $$PWD/qtpropertymultiedit.cpp \
+    $$PWD/qtpropertyobjectbinder.cpp \
+    $$PWD/qtpropertytextindex.cpp \
+    $$PWD/qtpropertyupdatequeue.cpp
 
 HEADERS  += \
     $$PWD/qtproperty.h \
@@ -31,4 +44,18 @@ HEADERS  += \
     $$PWD/qtpropertytype.h \
     $$PWD/qtbuttonpropertybrowser.h \
     $$PWD/qtbuttonpropertyitem.h \
+    $$PWD/qtpropertyattributes.h \
+    $$PWD/qtpropertydefinition.h \
+    $$PWD/qtpropertyarena.h \
+    $$PWD/qtpropertyvalue.h \
+    $$PWD/qtpropertyschema.h \
+    $$PWD/qtpropertysnapshot.h \
+    $$PWD/qtpropertyjson.h \
+    $$PWD/qtpropertydelta.h \
+    $$PWD/qtpropertyundo.h \
+    $$PWD/qtpropertymultiedit.h \
+    $$PWD/qtpropertyobjectbinder.h \
+    $$PWD/qtpropertytextindex.h \
+    $$PWD/qtpropertyupdatequeue.h \
+    $$PWD/qtnametable_p.h \
     $$PWD/qtpropertyconfig.h
@@ -0,0 +1,698 @@
+﻿#include "qtpropertysnapshot.h"
+#include "qtproperty.h"
+#include "qtpropertyfactory.h"
+#include "qtpropertydefinition.h"
+#include "qtattributename.h"
+
+#include <QFile>
+#include <QDataStream>
+#include <QHash>
+#include <QVector>
+#include <cstring>
+
+namespace
+{
+    const quint32 SNAPSHOT_MAGIC = 0x53505451; // "QTPS"
+    const quint32 SNAPSHOT_VERSION = 1;
+    const quint32 NO_DATA = 0xffffffff;
+
+    /** 节点值的存储方式。前几项与QtPropertyValue::Kind一致。*/
+    enum ValueKind
+    {
+        VALUE_NONE,
+        VALUE_INT,
+        VALUE_DOUBLE,
+        VALUE_BOOL,
+        VALUE_COLOR,
+        VALUE_VARIANT,  ///< blob中的QDataStream数据
+        VALUE_FLOATS,   ///< blob中连续的float
+        VALUE_DERIVED,  ///< 由子节点组成，不保存
+    };
+
+    enum NodeFlag
+    {
+        FLAG_VISIBLE = 1,
+        FLAG_SELF_VISIBLE = 2,
+        FLAG_MENU_VISIBLE = 4,
+    };
+
+    struct QtSnapshotHeader
+    {
+        quint32     magic;
+        quint32     version;
+        quint32     nodeCount;
+        quint32     definitionCount;
+        quint32     definitionOffset;
+        quint32     stringOffset;
+        quint32     blobOffset;
+        quint32     size;
+    };
+
+    struct QtSnapshotDefinition
+    {
+        quint32     blobOffset;
+        quint32     blobSize;
+    };
+}
+
+struct QtSnapshotNode
+{
+    qint32      parent;
+    quint32     childCount;
+    quint32     subtreeSize;
+    quint32     typeName;       ///< 字符串表中的偏移
+    quint32     name;           ///< 字符串表中的偏移
+    quint32     definition;     ///< 定义表中的序号
+    quint16     flags;
+    quint8      valueKind;
+    quint8      reserved;
+    quint32     blobOffset;
+    quint32     blobSize;
+    quint32     reserved2;
+    quint64     value;          ///< 标量值的二进制表示
+};
+
+Q_STATIC_ASSERT(sizeof(QtSnapshotHeader) == 32);
+Q_STATIC_ASSERT(sizeof(QtSnapshotNode) == 48);
+
+static void alignTo(QByteArray &data, int alignment)
+{
+    while(data.size() % alignment != 0)
+    {
+        data.append('\0');
+    }
+}
+
+/** 一次前序遍历写出所有节点，字符串、定义和值分别追加到各自的区域。*/
+class QtSnapshotWriter
+{
+public:
+    void write(const QtProperty *property, int parent);
+    QByteArray finish();
+
+private:
+    quint32 addString(const QString &str);
+    quint32 addDefinition(const QtPropertyDefinition &definition);
+    quint32 addBlob(const QByteArray &data);
+    void writeValue(const QtProperty *property, QtSnapshotNode &node);
+
+    QVector<QtSnapshotNode>         nodes_;
+    QVector<QtSnapshotDefinition>   definitions_;
+    QByteArray                      strings_;
+    QByteArray                      blobs_;
+
+    QHash<QString, quint32>         stringOffsets_;
+    QHash<const void*, quint32>     definitionIndices_;
+};
+
+quint32 QtSnapshotWriter::addString(const QString &str)
+{
+    QHash<QString, quint32>::const_iterator it = stringOffsets_.constFind(str);
+    if(it != stringOffsets_.constEnd())
+    {
+        return *it;
+    }
+
+    // length followed by the UTF-16 data, so it can be referenced in place.
+    quint32 offset = strings_.size();
+    quint32 length = str.size();
+    strings_.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    strings_.append(reinterpret_cast<const char*>(str.constData()), length * sizeof(QChar));
+    alignTo(strings_, 4);
+
+    stringOffsets_.insert(str, offset);
+    return offset;
+}
+
+quint32 QtSnapshotWriter::addBlob(const QByteArray &data)
+{
+    alignTo(blobs_, 8);
+    quint32 offset = blobs_.size();
+    blobs_.append(data);
+    return offset;
+}
+
+quint32 QtSnapshotWriter::addDefinition(const QtPropertyDefinition &definition)
+{
+    QHash<const void*, quint32>::const_iterator it = definitionIndices_.constFind(definition.getSharedKey());
+    if(it != definitionIndices_.constEnd())
+    {
+        return *it;
+    }
+
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << definition.getTitle();
+        stream << definition.getToolTip();
+        stream << QVariant(definition.getBackgroundColor());
+        stream << definition.getDefaultValue();
+
+        const QtPropertyAttributes &attributes = definition.getAttributes();
+        stream << quint32(attributes.size());
+        for(QtPropertyAttributes::const_iterator attr = attributes.begin(); attr != attributes.end(); ++attr)
+        {
+            stream << QtAttributeName::atomName(attr->atom);
+            stream << attr->value;
+        }
+    }
+
+    QtSnapshotDefinition record;
+    record.blobSize = data.size();
+    record.blobOffset = addBlob(data);
+
+    quint32 index = definitions_.size();
+    definitions_.push_back(record);
+    definitionIndices_.insert(definition.getSharedKey(), index);
+    return index;
+}
+
+void QtSnapshotWriter::writeValue(const QtProperty *property, QtSnapshotNode &node)
+{
+    node.valueKind = VALUE_NONE;
+    node.blobOffset = NO_DATA;
+    node.blobSize = 0;
+    node.value = 0;
+
+    if(dynamic_cast<const QtContainerProperty*>(property) != NULL || !property->hasValue())
+    {
+        node.valueKind = VALUE_DERIVED;
+        return;
+    }
+
+    const QtFloatListProperty *floatList = dynamic_cast<const QtFloatListProperty*>(property);
+    if(floatList != NULL)
+    {
+        const QVector<float> &values = floatList->getValues();
+        node.valueKind = VALUE_FLOATS;
+        node.blobSize = values.size() * sizeof(float);
+        node.blobOffset = addBlob(QByteArray::fromRawData(reinterpret_cast<const char*>(values.constData()), node.blobSize));
+        return;
+    }
+
+    if(property->getValueKind() != QtPropertyValue::VARIANT)
+    {
+        QtPropertyValue value = property->getScalarValue();
+        switch(value.getKind())
+        {
+        case QtPropertyValue::NONE:
+            return;
+        case QtPropertyValue::INT:
+        {
+            qint64 v = value.toInt();
+            memcpy(&node.value, &v, sizeof(v));
+            node.valueKind = VALUE_INT;
+            return;
+        }
+        case QtPropertyValue::DOUBLE:
+        {
+            double v = value.toDouble();
+            memcpy(&node.value, &v, sizeof(v));
+            node.valueKind = VALUE_DOUBLE;
+            return;
+        }
+        case QtPropertyValue::BOOL:
+            node.value = value.toBool() ? 1 : 0;
+            node.valueKind = VALUE_BOOL;
+            return;
+        case QtPropertyValue::COLOR:
+            node.value = value.toColor().rgba();
+            node.valueKind = VALUE_COLOR;
+            return;
+        default:
+            break;
+        }
+    }
+
+    const QVariant &value = property->getValue();
+    if(!value.isValid())
+    {
+        return;
+    }
+
+    QByteArray data;
+    {
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream << value;
+    }
+    node.valueKind = VALUE_VARIANT;
+    node.blobSize = data.size();
+    node.blobOffset = addBlob(data);
+}
+
+void QtSnapshotWriter::write(const QtProperty *property, int parent)
+{
+    QtSnapshotNode node;
+    memset(&node, 0, sizeof(node));
+    node.parent = parent;
+    node.typeName = addString(property->getTypeName());
+    node.name = addString(property->getName());
+    node.definition = addDefinition(property->getDefinition());
+    node.flags = (property->isVisible() ? FLAG_VISIBLE : 0) |
+            (property->isSelfVisible() ? FLAG_SELF_VISIBLE : 0) |
+            (property->isMenuVisible() ? FLAG_MENU_VISIBLE : 0);
+    writeValue(property, node);
+
+    int index = nodes_.size();
+    nodes_.push_back(node);
+
+    // generated children are rebuilt from the value.
+    quint32 childCount = 0;
+    if(!property->hasGeneratedChildren())
+    {
+        foreach(const QtProperty *child, property->getChildren())
+        {
+            write(child, index);
+            ++childCount;
+        }
+    }
+
+    nodes_[index].childCount = childCount;
+    nodes_[index].subtreeSize = nodes_.size() - index;
+}
+
+QByteArray QtSnapshotWriter::finish()
+{
+    QtSnapshotHeader header;
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.nodeCount = nodes_.size();
+    header.definitionCount = definitions_.size();
+    header.definitionOffset = sizeof(QtSnapshotHeader) + nodes_.size() * sizeof(QtSnapshotNode);
+    header.stringOffset = header.definitionOffset + definitions_.size() * sizeof(QtSnapshotDefinition);
+    header.blobOffset = (header.stringOffset + strings_.size() + 7) & ~7u;
+    header.size = header.blobOffset + blobs_.size();
+
+    QByteArray data;
+    data.reserve(header.size);
+    data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    data.append(reinterpret_cast<const char*>(nodes_.constData()), nodes_.size() * sizeof(QtSnapshotNode));
+    data.append(reinterpret_cast<const char*>(definitions_.constData()), definitions_.size() * sizeof(QtSnapshotDefinition));
+    data.append(strings_);
+    alignTo(data, 8);
+    data.append(blobs_);
+    return data;
+}
+
+/********************************************************************/
+QtPropertySnapshot::QtPropertySnapshot()
+    : file_(NULL)
+    , data_(NULL)
+    , size_(0)
+{
+
+}
+
+QtPropertySnapshot::~QtPropertySnapshot()
+{
+    close();
+}
+
+QByteArray QtPropertySnapshot::save(const QtProperty *root)
+{
+    QtSnapshotWriter writer;
+    writer.write(root, -1);
+    return writer.finish();
+}
+
+bool QtPropertySnapshot::save(const QtProperty *root, QIODevice *device)
+{
+    QByteArray data = save(root);
+    return device->write(data) == data.size();
+}
+
+bool QtPropertySnapshot::load(const QByteArray &data)
+{
+    close();
+    buffer_ = data;
+    if(!attach(reinterpret_cast<const uchar*>(buffer_.constData()), buffer_.size()))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool QtPropertySnapshot::open(const QString &path)
+{
+    close();
+
+    file_ = new QFile(path);
+    if(file_->open(QIODevice::ReadOnly))
+    {
+        const uchar *data = file_->map(0, file_->size());
+        if(data != NULL)
+        {
+            data_ = data;
+            if(attach(data, file_->size()))
+            {
+                return true;
+            }
+        }
+    }
+
+    close();
+    return false;
+}
+
+void QtPropertySnapshot::close()
+{
+    if(file_ != NULL)
+    {
+        if(data_ != NULL)
+        {
+            file_->unmap(const_cast<uchar*>(data_));
+        }
+        delete file_;
+        file_ = NULL;
+    }
+    buffer_.clear();
+    data_ = NULL;
+    size_ = 0;
+}
+
+bool QtPropertySnapshot::attach(const uchar *data, qint64 size)
+{
+    if(size < qint64(sizeof(QtSnapshotHeader)))
+    {
+        return false;
+    }
+
+    const QtSnapshotHeader *header = reinterpret_cast<const QtSnapshotHeader*>(data);
+    if(header->magic != SNAPSHOT_MAGIC || header->version != SNAPSHOT_VERSION || header->size > size)
+    {
+        return false;
+    }
+    if(header->nodeCount == 0 ||
+       header->definitionOffset != sizeof(QtSnapshotHeader) + header->nodeCount * sizeof(QtSnapshotNode) ||
+       header->stringOffset != header->definitionOffset + header->definitionCount * sizeof(QtSnapshotDefinition) ||
+       header->blobOffset < header->stringOffset ||
+       header->blobOffset > header->size)
+    {
+        return false;
+    }
+
+    data_ = data;
+    size_ = size;
+    return true;
+}
+
+int QtPropertySnapshot::getNodeCount() const
+{
+    if(data_ == NULL)
+    {
+        return 0;
+    }
+    return reinterpret_cast<const QtSnapshotHeader*>(data_)->nodeCount;
+}
+
+const QtSnapshotNode* QtPropertySnapshot::node(int index) const
+{
+    if(index < 0 || index >= getNodeCount())
+    {
+        return NULL;
+    }
+    return reinterpret_cast<const QtSnapshotNode*>(data_ + sizeof(QtSnapshotHeader)) + index;
+}
+
+QString QtPropertySnapshot::stringAt(quint32 offset) const
+{
+    const QtSnapshotHeader *header = reinterpret_cast<const QtSnapshotHeader*>(data_);
+    quint64 position = quint64(header->stringOffset) + offset;
+    if(position + sizeof(quint32) > header->blobOffset)
+    {
+        return QString();
+    }
+
+    quint32 length;
+    memcpy(&length, data_ + position, sizeof(length));
+    if(position + sizeof(quint32) + quint64(length) * sizeof(QChar) > header->blobOffset)
+    {
+        return QString();
+    }
+    return QString::fromRawData(reinterpret_cast<const QChar*>(data_ + position + sizeof(quint32)), length);
+}
+
+QByteArray QtPropertySnapshot::blob(quint32 offset, quint32 size) const
+{
+    const QtSnapshotHeader *header = reinterpret_cast<const QtSnapshotHeader*>(data_);
+    if(offset == NO_DATA || quint64(header->blobOffset) + offset + size > header->size)
+    {
+        return QByteArray();
+    }
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(data_ + header->blobOffset + offset), size);
+}
+
+int QtPropertySnapshot::getParent(int index) const
+{
+    const QtSnapshotNode *n = node(index);
+    return n != NULL ? n->parent : -1;
+}
+
+int QtPropertySnapshot::getChildCount(int index) const
+{
+    const QtSnapshotNode *n = node(index);
+    return n != NULL ? n->childCount : 0;
+}
+
+int QtPropertySnapshot::getSubtreeSize(int index) const
+{
+    const QtSnapshotNode *n = node(index);
+    return n != NULL ? n->subtreeSize : 0;
+}
+
+QString QtPropertySnapshot::getName(int index) const
+{
+    const QtSnapshotNode *n = node(index);
+    return n != NULL ? stringAt(n->name) : QString();
+}
+
+QtPropertyType::Type QtPropertySnapshot::getType(int index) const
+{
+    const QtSnapshotNode *n = node(index);
+    return n != NULL ? QtPropertyType::findType(stringAt(n->typeName)) : QtPropertyType::Type(QtPropertyType::NONE);
+}
+
+int QtPropertySnapshot::findNode(const QString &path) const
+{
+    if(getNodeCount() == 0)
+    {
+        return -1;
+    }
+
+    int current = 0;
+    foreach(const QString &name, path.split('/', QString::SkipEmptyParts))
+    {
+        // step from one child to the next by skipping whole subtrees.
+        const QtSnapshotNode *parent = node(current);
+        int child = current + 1;
+        int found = -1;
+        for(quint32 i = 0; i < parent->childCount; ++i)
+        {
+            const QtSnapshotNode *n = node(child);
+            if(n == NULL)
+            {
+                return -1;
+            }
+            if(stringAt(n->name) == name)
+            {
+                found = child;
+                break;
+            }
+            child += n->subtreeSize;
+        }
+        if(found < 0)
+        {
+            return -1;
+        }
+        current = found;
+    }
+    return current;
+}
+
+QtPropertyValue QtPropertySnapshot::getScalarValue(int index) const
+{
+    const QtSnapshotNode *n = node(index);
+    if(n == NULL)
+    {
+        return QtPropertyValue();
+    }
+
+    switch(n->valueKind)
+    {
+    case VALUE_INT:
+    {
+        qint64 v;
+        memcpy(&v, &n->value, sizeof(v));
+        return QtPropertyValue(v);
+    }
+    case VALUE_DOUBLE:
+    {
+        double v;
+        memcpy(&v, &n->value, sizeof(v));
+        return QtPropertyValue(v);
+    }
+    case VALUE_BOOL:
+        return QtPropertyValue(n->value != 0);
+    case VALUE_COLOR:
+        return QtPropertyValue(QColor::fromRgba(QRgb(n->value)));
+    case VALUE_VARIANT:
+    case VALUE_FLOATS:
+        return QtPropertyValue::fromVariant(getValue(index), QtPropertyValue::VARIANT);
+    default:
+        return QtPropertyValue();
+    }
+}
+
+QVariant QtPropertySnapshot::getValue(int index) const
+{
+    const QtSnapshotNode *n = node(index);
+    if(n == NULL)
+    {
+        return QVariant();
+    }
+
+    if(n->valueKind == VALUE_VARIANT)
+    {
+        QVariant value;
+        QDataStream stream(blob(n->blobOffset, n->blobSize));
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream >> value;
+        return value;
+    }
+    else if(n->valueKind == VALUE_FLOATS)
+    {
+        QByteArray data = blob(n->blobOffset, n->blobSize);
+        QVector<float> values(data.size() / sizeof(float));
+        memcpy(values.data(), data.constData(), values.size() * sizeof(float));
+        return QVariant::fromValue(values);
+    }
+    return getScalarValue(index).toVariant();
+}
+
+static QtPropertyDefinition readDefinition(const QByteArray &data, QtPropertyType::Type type, const QString &name)
+{
+    QtPropertyDefinition definition(type, name);
+
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    QString title, tips;
+    QVariant bgColor, defaultValue;
+    quint32 attributeCount = 0;
+    stream >> title >> tips >> bgColor >> defaultValue >> attributeCount;
+
+    definition.setTitle(title);
+    definition.setToolTip(tips);
+    definition.setBackgroundColor(bgColor.value<QColor>());
+    definition.setDefaultValue(defaultValue);
+
+    for(quint32 i = 0; i < attributeCount && stream.status() == QDataStream::Ok; ++i)
+    {
+        QString attributeName;
+        QVariant value;
+        stream >> attributeName >> value;
+        definition.setAttribute(attributeName, value);
+    }
+    return definition;
+}
+
+QtProperty* QtPropertySnapshot::restore(QtPropertyFactory *factory) const
+{
+    int count = getNodeCount();
+    if(count == 0)
+    {
+        return NULL;
+    }
+
+    const QtSnapshotHeader *header = reinterpret_cast<const QtSnapshotHeader*>(data_);
+    const QtSnapshotDefinition *definitionRecords = reinterpret_cast<const QtSnapshotDefinition*>(data_ + header->definitionOffset);
+
+    // each shared definition is decoded once, and shared again by the new properties.
+    QVector<QtPropertyDefinition> definitions(header->definitionCount);
+    QVector<bool> decoded(header->definitionCount, false);
+    QHash<quint32, QtPropertyType::Type> types;
+    QVector<QtProperty*> properties(count, NULL);
+    QtProperty *root = NULL;
+
+    for(int i = 0; i < count; ++i)
+    {
+        const QtSnapshotNode *n = node(i);
+
+        // a node whose parent is missing or skipped is not restored, nor its subtree.
+        QtProperty *parent = NULL;
+        if(i > 0)
+        {
+            if(n->parent < 0 || n->parent >= i || properties[n->parent] == NULL)
+            {
+                continue;
+            }
+            parent = properties[n->parent];
+        }
+
+        QHash<quint32, QtPropertyType::Type>::iterator it = types.find(n->typeName);
+        if(it == types.end())
+        {
+            // the registry keeps the name after the mapping is gone, copy it out of the file.
+            QString typeName = stringAt(n->typeName);
+            it = types.insert(n->typeName, QtPropertyType::registerType(QString(typeName.constData(), typeName.size())));
+        }
+        QtPropertyType::Type type = *it;
+
+        QtProperty *property = factory->createProperty(type);
+        properties[i] = property;
+        if(parent == NULL)
+        {
+            // everything below is attached to the root first, so that all the
+            // notifications of the restore are merged into one batch.
+            root = property;
+            root->beginUpdate();
+        }
+        else
+        {
+            // the new tree has no listeners of its own, insertions are not reported.
+            parent->attachChild(property);
+        }
+
+        if(n->definition < header->definitionCount)
+        {
+            if(!decoded[n->definition])
+            {
+                const QtSnapshotDefinition &record = definitionRecords[n->definition];
+                // the string is copied, the definition outlives the mapping.
+                QString name(stringAt(n->name).constData(), stringAt(n->name).size());
+                definitions[n->definition] = readDefinition(blob(record.blobOffset, record.blobSize), type, name);
+                decoded[n->definition] = true;
+            }
+            property->setDefinition(definitions[n->definition]);
+        }
+
+        property->setVisible((n->flags & FLAG_VISIBLE) != 0);
+        property->setSelfVisible((n->flags & FLAG_SELF_VISIBLE) != 0);
+        property->setMenuVisible((n->flags & FLAG_MENU_VISIBLE) != 0);
+
+        // values are assigned after attaching, so that containers collect them.
+        if(n->valueKind == VALUE_FLOATS)
+        {
+            QtFloatListProperty *floatList = dynamic_cast<QtFloatListProperty*>(property);
+            QByteArray data = blob(n->blobOffset, n->blobSize);
+            if(floatList != NULL)
+            {
+                floatList->setValues(reinterpret_cast<const float*>(data.constData()), data.size() / sizeof(float));
+            }
+        }
+        else if(n->valueKind == VALUE_VARIANT)
+        {
+            property->setValue(getValue(i));
+        }
+        else if(n->valueKind != VALUE_NONE && n->valueKind != VALUE_DERIVED)
+        {
+            property->setScalarValue(getScalarValue(i));
+        }
+    }
+
+    root->endUpdate();
+    return root;
+}
@@ -0,0 +1,85 @@
+﻿#ifndef QTPROPERTYSNAPSHOT_H
+#define QTPROPERTYSNAPSHOT_H
+
+#include "qtpropertyconfig.h"
+#include "qtpropertytype.h"
+#include "qtpropertyvalue.h"
+#include <QByteArray>
+#include <QVariant>
+#include <QString>
+
+class QFile;
+class QIODevice;
+class QtProperty;
+class QtPropertyFactory;
+struct QtSnapshotNode;
+
+/**
+ * @brief The QtPropertySnapshot class
+ *
+ * Compact binary image of a whole property tree: structure, types, names,
+ * definitions and values. The image is written in one pre-order pass and has
+ * fixed size node records, so a memory mapped file can be queried node by
+ * node without decoding the rest. restore() rebuilds the tree through a
+ * QtPropertyFactory in one linear pass.
+ *
+ * Layout: header, node records, definition records, string table, blobs.
+ * Numbers are stored in native byte order; an image written on a machine
+ * with the other byte order is rejected. Definitions shared by several
+ * properties are stored once.
+ */
+class QTPROPERTYSHEET_DLL QtPropertySnapshot
+{
+public:
+    QtPropertySnapshot();
+    ~QtPropertySnapshot();
+
+    /** 把root为根的属性树写成快照。*/
+    static QByteArray save(const QtProperty *root);
+    static bool save(const QtProperty *root, QIODevice *device);
+
+    /** 使用内存中的快照，data被隐式共享，不会复制。*/
+    bool load(const QByteArray &data);
+
+    /** 以内存映射的方式打开快照文件。*/
+    bool open(const QString &path);
+    void close();
+
+    bool isValid() const { return data_ != NULL; }
+
+    /** 节点按前序排列，0是根节点。*/
+    int getNodeCount() const;
+    int getParent(int node) const;
+    int getChildCount(int node) const;
+    /** 包括自身在内的子树节点数，node + getSubtreeSize(node)是下一个兄弟或更高层节点。*/
+    int getSubtreeSize(int node) const;
+
+    /** 名称直接引用快照中的数据，快照关闭后不可再使用。*/
+    QString getName(int node) const;
+    QtPropertyType::Type getType(int node) const;
+
+    /** 按'/'分隔的名称路径查找节点，路径相对于根节点。找不到返回-1。*/
+    int findNode(const QString &path) const;
+
+    /** 读取节点的值，不需要重建属性树。容器的值由子节点组成，这里返回空值。*/
+    QtPropertyValue getScalarValue(int node) const;
+    QVariant getValue(int node) const;
+
+    /** 通过factory重建整棵属性树。*/
+    QtProperty* restore(QtPropertyFactory *factory) const;
+
+private:
+    Q_DISABLE_COPY(QtPropertySnapshot)
+
+    bool attach(const uchar *data, qint64 size);
+    const QtSnapshotNode* node(int index) const;
+    QString stringAt(quint32 offset) const;
+    QByteArray blob(quint32 offset, quint32 size) const;
+
+    QByteArray      buffer_;
+    QFile*          file_;
+    const uchar*    data_;
+    qint64          size_;
+};
+
+#endif // QTPROPERTYSNAPSHOT_H
@@ -0,0 +1,150 @@
+﻿#include "qtpropertytextindex.h"
+
+namespace
+{
+    const int TrigramSize = 3;
+}
+
+void QtPropertyTextIndex::collectTrigrams(const QString &text, QSet<Trigram> &trigrams)
+{
+    const QChar *data = text.constData();
+    for(int i = 0; i + TrigramSize <= text.size(); ++i)
+    {
+        Trigram trigram = (Trigram(data[i].unicode()) << 32) |
+                (Trigram(data[i + 1].unicode()) << 16) |
+                Trigram(data[i + 2].unicode());
+        trigrams.insert(trigram);
+    }
+}
+
+void QtPropertyTextIndex::addPostings(QtProperty *property, const QSet<Trigram> &trigrams, const QSet<Trigram> &except)
+{
+    foreach(Trigram trigram, trigrams)
+    {
+        if(!except.contains(trigram))
+        {
+            postings_[trigram].insert(property);
+        }
+    }
+}
+
+void QtPropertyTextIndex::removePostings(QtProperty *property, const QSet<Trigram> &trigrams, const QSet<Trigram> &except)
+{
+    foreach(Trigram trigram, trigrams)
+    {
+        if(except.contains(trigram))
+        {
+            continue;
+        }
+
+        QHash<Trigram, Postings>::iterator it = postings_.find(trigram);
+        if(it != postings_.end())
+        {
+            it->remove(property);
+            if(it->isEmpty())
+            {
+                postings_.erase(it);
+            }
+        }
+    }
+}
+
+void QtPropertyTextIndex::insert(QtProperty *property, const QString &text)
+{
+    QString lower = text.toLower();
+    QHash<QtProperty*, QString>::iterator it = texts_.find(property);
+    if(it != texts_.end() && *it == lower)
+    {
+        return;
+    }
+
+    // a value edit usually changes a few characters, keep the shared trigrams.
+    QSet<Trigram> oldTrigrams, newTrigrams;
+    if(it != texts_.end())
+    {
+        collectTrigrams(*it, oldTrigrams);
+    }
+    collectTrigrams(lower, newTrigrams);
+
+    removePostings(property, oldTrigrams, newTrigrams);
+    addPostings(property, newTrigrams, oldTrigrams);
+    texts_.insert(property, lower);
+}
+
+void QtPropertyTextIndex::remove(QtProperty *property)
+{
+    QHash<QtProperty*, QString>::iterator it = texts_.find(property);
+    if(it != texts_.end())
+    {
+        QSet<Trigram> trigrams;
+        collectTrigrams(*it, trigrams);
+        removePostings(property, trigrams, QSet<Trigram>());
+        texts_.erase(it);
+    }
+}
+
+void QtPropertyTextIndex::clear()
+{
+    texts_.clear();
+    postings_.clear();
+}
+
+QVector<QtProperty*> QtPropertyTextIndex::find(const QString &query) const
+{
+    QVector<QtProperty*> result;
+    QString lower = query.toLower();
+    if(lower.isEmpty())
+    {
+        return result;
+    }
+
+    if(lower.size() < TrigramSize)
+    {
+        for(QHash<QtProperty*, QString>::const_iterator it = texts_.constBegin(); it != texts_.constEnd(); ++it)
+        {
+            if(it->contains(lower))
+            {
+                result.push_back(it.key());
+            }
+        }
+        return result;
+    }
+
+    QSet<Trigram> trigrams;
+    collectTrigrams(lower, trigrams);
+
+    QVector<const Postings*> lists;
+    const Postings *smallest = NULL;
+    foreach(Trigram trigram, trigrams)
+    {
+        QHash<Trigram, Postings>::const_iterator it = postings_.constFind(trigram);
+        if(it == postings_.constEnd())
+        {
+            return result;
+        }
+        lists.push_back(&*it);
+        if(smallest == NULL || it->size() < smallest->size())
+        {
+            smallest = &*it;
+        }
+    }
+
+    // the trigrams may appear in another order, confirm each candidate.
+    foreach(QtProperty *property, *smallest)
+    {
+        bool candidate = true;
+        foreach(const Postings *list, lists)
+        {
+            if(list != smallest && !list->contains(property))
+            {
+                candidate = false;
+                break;
+            }
+        }
+        if(candidate && texts_.value(property).contains(lower))
+        {
+            result.push_back(property);
+        }
+    }
+    return result;
+}
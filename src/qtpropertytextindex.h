@@ -0,0 +1,51 @@
+﻿#ifndef QTPROPERTYTEXTINDEX_H
+#define QTPROPERTYTEXTINDEX_H
+
+#include "qtpropertyconfig.h"
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class QtProperty;
+
+/**
+ * @brief The QtPropertyTextIndex class
+ *
+ * Case insensitive substring search over one text per property, backed by a
+ * trigram index. Every three consecutive characters of a text map to the set
+ * of properties containing them; a query intersects the sets of its own
+ * trigrams, starting with the smallest, and checks the few candidates left.
+ * The cost follows the number of candidates, not the number of properties.
+ *
+ * Texts are replaced incrementally: only the trigrams that appear or vanish
+ * are touched. Queries shorter than three characters scan all texts, they
+ * match most properties anyway.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyTextIndex
+{
+public:
+    /** 设置property的文本，替换原有的文本。*/
+    void insert(QtProperty *property, const QString &text);
+    void remove(QtProperty *property);
+    void clear();
+
+    bool contains(QtProperty *property) const { return texts_.contains(property); }
+    int count() const { return texts_.size(); }
+
+    /** 文本中包含query的所有属性，不区分大小写，顺序不确定。*/
+    QVector<QtProperty*> find(const QString &query) const;
+
+private:
+    typedef quint64 Trigram;
+    typedef QSet<QtProperty*> Postings;
+
+    static void collectTrigrams(const QString &text, QSet<Trigram> &trigrams);
+    void addPostings(QtProperty *property, const QSet<Trigram> &trigrams, const QSet<Trigram> &except);
+    void removePostings(QtProperty *property, const QSet<Trigram> &trigrams, const QSet<Trigram> &except);
+
+    QHash<QtProperty*, QString> texts_;     ///< 已转为小写
+    QHash<Trigram, Postings>    postings_;
+};
+
+#endif // QTPROPERTYTEXTINDEX_H
@@ -115,15 +115,8 @@ void QtPropertyTreeDelegate::paint(QPainter *painter, const QStyleOptionViewItem
         }
     }
 
+    // modified properties are shown bold through the font of the item.
     QStyleOptionViewItem opt = option;
-    if ((editorPrivate_ && index.column() == 0) || !hasValue)
-    {
-        if (property && property->isModified())
-        {
-            opt.font.setBold(true);
-            opt.fontMetrics = QFontMetrics(opt.font);
-        }
-    }
 
     if (!hasValue && editorPrivate_->markPropertiesWithoutValue())
     {
@@ -1,23 +1,58 @@
 ﻿#include "qtpropertytype.h"
+#include "qtnametable_p.h"
+
+namespace
+{
+    QtNameTable createRegistry()
+    {
+        QtNameTable table;
+
+        // must match the order of QtPropertyType::BuiltinType.
+        table.add("none");
+        table.add("bool");
+        table.add("int");
+        table.add("float");
+        table.add("string");
+        table.add("group");
+        table.add("list");
+        table.add("dict");
+        table.add("enum");
+        table.add("flag");
+        table.add("color");
+        table.add("file");
+        table.add("dynamicList");
+        table.add("dynamicItem");
+        table.add("enumPair");
+        table.add("floatList");
+        return table;
+    }
+
+    QtNameTable& registry()
+    {
+        static QtNameTable table = createRegistry();
+        return table;
+    }
+}
 
 namespace QtPropertyType
 {
+    Type registerType(const QString &name)
+    {
+        return registry().add(name);
+    }
+
+    Type findType(const QString &name)
+    {
+        return registry().find(name, NONE);
+    }
 
-	const Type NONE = "none";
-	const Type BOOL = "bool";
-	const Type INT = "int";
-    const Type FLOAT = "float";
-	const Type STRING = "string";
-	const Type GROUP = "group";
-	const Type LIST = "list";
-	const Type DICT = "dict";
-	const Type ENUM = "enum";
-	const Type FLAG = "flag";
-	const Type COLOR = "color";
-	const Type FILE = "file";
-	const Type DYNAMIC_LIST = "dynamicList";
-	const Type DYNAMIC_ITEM = "dynamicItem";
-	const Type ENUM_PAIR = "enumPair";
-    const Type FLOAT_LIST = "floatList";
+    QString typeName(Type type)
+    {
+        return registry().name(type);
+    }
 
+    int numTypes()
+    {
+        return registry().size();
+    }
 }
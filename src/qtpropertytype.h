@@ -6,23 +6,44 @@
 
 namespace QtPropertyType
 {
-	typedef QString Type;
-    QTPROPERTYSHEET_DLL extern const Type NONE;
-    QTPROPERTYSHEET_DLL extern const Type BOOL;
-    QTPROPERTYSHEET_DLL extern const Type INT;
-    QTPROPERTYSHEET_DLL extern const Type FLOAT;
-    QTPROPERTYSHEET_DLL extern const Type STRING;
-    QTPROPERTYSHEET_DLL extern const Type GROUP;
-    QTPROPERTYSHEET_DLL extern const Type LIST;
-    QTPROPERTYSHEET_DLL extern const Type DICT;
-    QTPROPERTYSHEET_DLL extern const Type ENUM;
-    QTPROPERTYSHEET_DLL extern const Type FLAG;
-    QTPROPERTYSHEET_DLL extern const Type COLOR;
-    QTPROPERTYSHEET_DLL extern const Type FILE;
-    QTPROPERTYSHEET_DLL extern const Type DYNAMIC_LIST;
-    QTPROPERTYSHEET_DLL extern const Type DYNAMIC_ITEM;
-    QTPROPERTYSHEET_DLL extern const Type ENUM_PAIR;
-    QTPROPERTYSHEET_DLL extern const Type FLOAT_LIST;
+    /** 属性类型。每种类型对应一个很小的整数id，可直接用作数组下标。
+     *  内置类型的id是编译期常量；自定义类型通过registerType注册得到id。
+     */
+    typedef int Type;
+
+    enum BuiltinType
+    {
+        NONE,
+        BOOL,
+        INT,
+        FLOAT,
+        STRING,
+        GROUP,
+        LIST,
+        DICT,
+        ENUM,
+        FLAG,
+        COLOR,
+        FILE,
+        DYNAMIC_LIST,
+        DYNAMIC_ITEM,
+        ENUM_PAIR,
+        FLOAT_LIST,
+
+        NUM_BUILTIN_TYPES
+    };
+
+    /** 注册类型名称，返回它的id。重复注册同一个名称返回相同的id。*/
+    QTPROPERTYSHEET_DLL Type registerType(const QString &name);
+
+    /** 根据名称查找类型id，未注册的名称返回NONE。*/
+    QTPROPERTYSHEET_DLL Type findType(const QString &name);
+
+    /** 返回类型的名称，如"int"、"group"。无效的id返回空字符串。*/
+    QTPROPERTYSHEET_DLL QString typeName(Type type);
+
+    /** 已注册的类型数量，所有类型id都小于这个值。*/
+    QTPROPERTYSHEET_DLL int numTypes();
 }
 
 #endif // QTPROPERTYTYPE_H
@@ -0,0 +1,287 @@
+﻿#include "qtpropertyundo.h"
+#include "qtproperty.h"
+
+#include <QHash>
+#include <QStringList>
+#include <algorithm>
+
+namespace
+{
+    /** 属性树的根到undo栈的映射。属性本身不保存undo栈，以免增加每个属性的大小。*/
+    typedef QHash<const QtProperty*, QtPropertyUndoStack*> StackRegistry;
+    StackRegistry undoStacks;
+}
+
+QtPropertyUndoStack::QtPropertyUndoStack(QtProperty *root, QObject *parent)
+    : QObject(parent)
+    , root_(root)
+    , index_(0)
+    , groupDepth_(0)
+    , applying_(false)
+    , mergeable_(false)
+    , mergeInterval_(500)
+    , limit_(0)
+{
+    group_.time = 0;
+    clock_.start();
+
+    undoStacks.insert(root_, this);
+    connect(root_->getNotifier(), SIGNAL(signalDestroyed(QtProperty*)), this, SLOT(onRootDestroyed(QtProperty*)));
+}
+
+QtPropertyUndoStack::~QtPropertyUndoStack()
+{
+    if(root_ != NULL)
+    {
+        undoStacks.remove(root_);
+    }
+}
+
+QtPropertyUndoStack* QtPropertyUndoStack::find(QtProperty *property)
+{
+    if(undoStacks.isEmpty())
+    {
+        return NULL;
+    }
+
+    for(; property != NULL; property = property->getParent())
+    {
+        StackRegistry::const_iterator it = undoStacks.constFind(property);
+        if(it != undoStacks.constEnd())
+        {
+            return *it;
+        }
+    }
+    return NULL;
+}
+
+void QtPropertyUndoStack::onRootDestroyed(QtProperty* /*root*/)
+{
+    undoStacks.remove(root_);
+    root_ = NULL;
+    clear();
+}
+
+bool QtPropertyUndoStack::pathOf(QtProperty *property, QString &path) const
+{
+    QStringList names;
+    for(; property != root_; property = property->getParent())
+    {
+        if(property == NULL)
+        {
+            return false;
+        }
+
+        // the value of a dynamic item is edited through its hidden impl.
+        QtDynamicItemProperty *item = dynamic_cast<QtDynamicItemProperty*>(property->getParent());
+        if(item != NULL && item->getImpl() == property)
+        {
+            continue;
+        }
+        names.push_front(property->getName());
+    }
+    path = names.join('/');
+    return true;
+}
+
+void QtPropertyUndoStack::record(QtProperty *property, const QtValueEntry &oldValue)
+{
+    if(applying_ || root_ == NULL)
+    {
+        return;
+    }
+
+    QString path;
+    if(!pathOf(property, path))
+    {
+        return;
+    }
+
+    QtValueEntry newValue = oldValue.isPartial() ?
+                QtValueEntry::captureComponent(property, oldValue.components.first(), path) :
+                QtValueEntry::capture(property, path);
+    if(newValue.sameValue(oldValue))
+    {
+        return;
+    }
+
+    QtValueEntry undoValue = oldValue;
+    undoValue.path = path;
+
+    if(groupDepth_ > 0)
+    {
+        // the first old value and the last new value of each path are kept.
+        group_.undo.setValue(undoValue, false);
+        group_.redo.setValue(newValue);
+        return;
+    }
+
+    qint64 now = clock_.elapsed();
+    if(mergeable_ && index_ == steps_.size() && index_ > 0)
+    {
+        Step &last = steps_[index_ - 1];
+        if(last.path == path && now - last.time <= mergeInterval_)
+        {
+            // another component of the same float list has no old value in the step yet.
+            last.undo.setValue(undoValue, false);
+            last.redo.setValue(newValue);
+            last.time = now;
+            return;
+        }
+    }
+
+    Step step;
+    step.undo.setValue(undoValue);
+    step.redo.setValue(newValue);
+    step.text = property->getTitle();
+    step.path = path;
+    step.time = now;
+    push(step);
+    mergeable_ = mergeInterval_ > 0;
+}
+
+void QtPropertyUndoStack::push(const Step &step)
+{
+    // a new step drops everything that was undone.
+    steps_.resize(index_);
+    steps_.push_back(step);
+
+    if(limit_ > 0 && steps_.size() > limit_)
+    {
+        steps_.remove(0, steps_.size() - limit_);
+    }
+    index_ = steps_.size();
+    emit signalIndexChanged(index_);
+}
+
+void QtPropertyUndoStack::beginGroup(const QString &text)
+{
+    if(groupDepth_++ == 0)
+    {
+        group_ = Step();
+        group_.text = text;
+        group_.time = 0;
+    }
+}
+
+void QtPropertyUndoStack::endGroup()
+{
+    Q_ASSERT(groupDepth_ > 0);
+    if(--groupDepth_ > 0)
+    {
+        return;
+    }
+
+    if(!group_.redo.isEmpty())
+    {
+        group_.time = clock_.elapsed();
+        push(group_);
+        mergeable_ = false;
+    }
+    group_ = Step();
+}
+
+QString QtPropertyUndoStack::getUndoText() const
+{
+    return canUndo() ? steps_[index_ - 1].text : QString();
+}
+
+QString QtPropertyUndoStack::getRedoText() const
+{
+    return canRedo() ? steps_[index_].text : QString();
+}
+
+void QtPropertyUndoStack::undo()
+{
+    if(!canUndo() || root_ == NULL)
+    {
+        return;
+    }
+
+    --index_;
+    applying_ = true;
+    steps_[index_].undo.apply(root_);
+    applying_ = false;
+    mergeable_ = false;
+
+    emit signalIndexChanged(index_);
+}
+
+void QtPropertyUndoStack::redo()
+{
+    if(!canRedo() || root_ == NULL)
+    {
+        return;
+    }
+
+    applying_ = true;
+    steps_[index_].redo.apply(root_);
+    applying_ = false;
+    ++index_;
+    mergeable_ = false;
+
+    emit signalIndexChanged(index_);
+}
+
+void QtPropertyUndoStack::clear()
+{
+    steps_.clear();
+    index_ = 0;
+    mergeable_ = false;
+    emit signalIndexChanged(index_);
+}
+
+void QtPropertyUndoStack::setLimit(int limit)
+{
+    limit_ = limit;
+    if(limit_ > 0 && steps_.size() > limit_)
+    {
+        // keep the steps around the current index, redo steps go first.
+        int redoCount = std::min(steps_.size() - index_, steps_.size() - limit_);
+        steps_.resize(steps_.size() - redoCount);
+        int undoCount = steps_.size() - limit_;
+        if(undoCount > 0)
+        {
+            steps_.remove(0, undoCount);
+            index_ -= undoCount;
+        }
+        emit signalIndexChanged(index_);
+    }
+}
+
+/********************************************************************/
+QtPropertyUndoRecorder::QtPropertyUndoRecorder(QtProperty *property)
+    : property_(property)
+    , stack_(QtPropertyUndoStack::find(property))
+{
+    if(stack_ != NULL && !stack_->isApplying())
+    {
+        oldValue_ = QtValueEntry::capture(property_, QString());
+    }
+    else
+    {
+        stack_ = NULL;
+    }
+}
+
+QtPropertyUndoRecorder::QtPropertyUndoRecorder(QtProperty *property, int component)
+    : property_(property)
+    , stack_(QtPropertyUndoStack::find(property))
+{
+    if(stack_ != NULL && !stack_->isApplying())
+    {
+        oldValue_ = QtValueEntry::captureComponent(property_, component, QString());
+    }
+    else
+    {
+        stack_ = NULL;
+    }
+}
+
+QtPropertyUndoRecorder::~QtPropertyUndoRecorder()
+{
+    if(stack_ != NULL)
+    {
+        stack_->record(property_, oldValue_);
+    }
+}
@@ -0,0 +1,121 @@
+﻿#ifndef QTPROPERTYUNDO_H
+#define QTPROPERTYUNDO_H
+
+#include "qtpropertyconfig.h"
+#include "qtpropertydelta.h"
+#include <QObject>
+#include <QVector>
+#include <QElapsedTimer>
+
+class QtProperty;
+
+/**
+ * @brief The QtPropertyUndoStack class
+ *
+ * Undo history of the values of one property tree. Each step keeps only the
+ * paths it touched, with their old and new values as QtValueEntry, and is
+ * replayed through QtPropertyDelta::apply in one batch update.
+ *
+ * Editors report their commits through QtPropertyUndoRecorder. Consecutive
+ * edits of the same property within the merge interval, such as dragging a
+ * spin box, are merged into one step.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyUndoStack : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QtPropertyUndoStack(QtProperty *root, QObject *parent = NULL);
+    ~QtPropertyUndoStack();
+
+    /** 查找property所在属性树的undo栈，没有时返回NULL。*/
+    static QtPropertyUndoStack* find(QtProperty *property);
+
+    QtProperty* getRoot() const { return root_; }
+
+    /** 记录一次修改。property的新值从属性中读取，oldValue的路径被忽略。
+     *  oldValue只有部分分量时，只读取这些分量的新值。
+     */
+    void record(QtProperty *property, const QtValueEntry &oldValue);
+
+    /** 在beginGroup和endGroup之间的修改合并为一步。可以嵌套。*/
+    void beginGroup(const QString &text = QString());
+    void endGroup();
+
+    bool canUndo() const { return index_ > 0; }
+    bool canRedo() const { return index_ < steps_.size(); }
+    QString getUndoText() const;
+    QString getRedoText() const;
+
+    void undo();
+    void redo();
+    void clear();
+
+    int count() const { return steps_.size(); }
+    int getIndex() const { return index_; }
+
+    /** 正在执行undo或redo，此时的修改不会被记录。*/
+    bool isApplying() const { return applying_; }
+
+    /** 对同一属性的连续修改，间隔不超过msec时合并，0表示不合并。默认500毫秒。*/
+    void setMergeInterval(int msec){ mergeInterval_ = msec; }
+    int getMergeInterval() const { return mergeInterval_; }
+
+    /** 最多保留的步数，0表示不限制。*/
+    void setLimit(int limit);
+    int getLimit() const { return limit_; }
+
+signals:
+    void signalIndexChanged(int index);
+
+private slots:
+    void onRootDestroyed(QtProperty *root);
+
+private:
+    struct Step
+    {
+        QtPropertyDelta     undo;
+        QtPropertyDelta     redo;
+        QString             text;
+        QString             path;   ///< 单个属性的修改才可以合并
+        qint64              time;
+    };
+
+    /** property相对于root_的路径，不在树中时返回false。*/
+    bool pathOf(QtProperty *property, QString &path) const;
+    void push(const Step &step);
+
+    QtProperty*         root_;
+    QVector<Step>       steps_;
+    int                 index_;
+
+    Step                group_;
+    int                 groupDepth_;
+
+    bool                applying_;
+    bool                mergeable_;
+    int                 mergeInterval_;
+    int                 limit_;
+    QElapsedTimer       clock_;
+};
+
+/** 在作用域内记录property的修改：构造时保存旧值，析构时把新值提交给undo栈。
+ *  属性树没有undo栈时不做任何事情。
+ */
+class QTPROPERTYSHEET_DLL QtPropertyUndoRecorder
+{
+public:
+    explicit QtPropertyUndoRecorder(QtProperty *property);
+
+    /** 只记录float list的第component个分量。*/
+    QtPropertyUndoRecorder(QtProperty *property, int component);
+    ~QtPropertyUndoRecorder();
+
+private:
+    Q_DISABLE_COPY(QtPropertyUndoRecorder)
+
+    QtProperty*             property_;
+    QtPropertyUndoStack*    stack_;
+    QtValueEntry            oldValue_;
+};
+
+#endif // QTPROPERTYUNDO_H
@@ -0,0 +1,157 @@
+﻿#include "qtpropertyupdatequeue.h"
+#include "qtproperty.h"
+
+#include <QTimer>
+#include <QMetaObject>
+
+QtPropertyUpdateQueue::QtPropertyUpdateQueue(QObject *parent)
+    : QObject(parent)
+    , head_(NULL)
+    , frameInterval_(16)
+{
+    lastDrain_.start();
+}
+
+QtPropertyUpdateQueue::~QtPropertyUpdateQueue()
+{
+    deleteList(head_.fetchAndStoreAcquire(NULL));
+}
+
+void QtPropertyUpdateQueue::deleteList(Node *node)
+{
+    while(node != NULL)
+    {
+        Node *next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+int QtPropertyUpdateQueue::registerProperty(QtProperty *property)
+{
+    QHash<QtProperty*, int>::const_iterator it = handles_.constFind(property);
+    if(it != handles_.constEnd() && properties_[*it] == property)
+    {
+        return *it;
+    }
+
+    // a new property at the address of a deleted one gets a new handle.
+    int handle = properties_.size();
+    properties_.push_back(property);
+    latest_.push_back(NULL);
+    handles_.insert(property, handle);
+    return handle;
+}
+
+QtProperty* QtPropertyUpdateQueue::getProperty(int handle) const
+{
+    return handle >= 0 && handle < properties_.size() ? properties_[handle].data() : NULL;
+}
+
+void QtPropertyUpdateQueue::post(int handle, const QVariant &value)
+{
+    post(handle, QtPropertyValue::fromVariant(value, QtPropertyValue::VARIANT));
+}
+
+void QtPropertyUpdateQueue::post(int handle, const QtPropertyValue &value)
+{
+    Node *node = new Node();
+    node->handle = handle;
+    node->value = value;
+
+    Node *head;
+    do
+    {
+        head = head_.load();
+        node->next = head;
+    }
+    while(!head_.testAndSetRelease(head, node));
+
+    // only the first value after a drain wakes the GUI thread.
+    if(head == NULL)
+    {
+        QMetaObject::invokeMethod(this, "onWake", Qt::QueuedConnection);
+    }
+}
+
+void QtPropertyUpdateQueue::onWake()
+{
+    qint64 remaining = frameInterval_ - lastDrain_.elapsed();
+    if(remaining > 0)
+    {
+        QTimer::singleShot(int(remaining), this, SLOT(drain()));
+    }
+    else
+    {
+        drain();
+    }
+}
+
+void QtPropertyUpdateQueue::drain()
+{
+    lastDrain_.restart();
+
+    Node *list = head_.fetchAndStoreAcquire(NULL);
+    if(list == NULL)
+    {
+        return;
+    }
+
+    // the list runs from the newest value to the oldest, the first node seen
+    // for a handle is the one that wins.
+    for(Node *node = list; node != NULL; node = node->next)
+    {
+        int handle = node->handle;
+        if(handle >= 0 && handle < latest_.size() && latest_[handle] == NULL)
+        {
+            latest_[handle] = node;
+            touched_.push_back(handle);
+        }
+    }
+
+    // one batch per tree, the signals are sent once all values are set.
+    QVector<QtPropertyPointer> roots;
+    foreach(int handle, touched_)
+    {
+        QtProperty *property = properties_[handle];
+        if(property == NULL)
+        {
+            continue;
+        }
+
+        QtProperty *root = property;
+        while(root->getParent() != NULL)
+        {
+            root = root->getParent();
+        }
+        if(!roots.contains(root))
+        {
+            roots.push_back(root);
+            root->beginUpdate();
+        }
+    }
+
+    // values are applied in the order of their last post, oldest first.
+    for(int i = touched_.size() - 1; i >= 0; --i)
+    {
+        int handle = touched_[i];
+        QtProperty *property = properties_[handle];
+        if(property != NULL)
+        {
+            property->setScalarValue(latest_[handle]->value);
+        }
+        latest_[handle] = NULL;
+    }
+    touched_.clear();
+
+    // a handler of an earlier tree may delete a later one.
+    foreach(const QtPropertyPointer &root, roots)
+    {
+        if(root != NULL)
+        {
+            root->endUpdate();
+        }
+    }
+
+    deleteList(list);
+}
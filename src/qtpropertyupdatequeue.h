@@ -0,0 +1,82 @@
+﻿#ifndef QTPROPERTYUPDATEQUEUE_H
+#define QTPROPERTYUPDATEQUEUE_H
+
+#include "qtpropertyconfig.h"
+#include "qtpropertyvalue.h"
+#include "qtproperty.h"
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+
+/**
+ * @brief The QtPropertyUpdateQueue class
+ *
+ * Carries property values from worker threads to the GUI thread.
+ *
+ * Properties are registered on the GUI thread and get an integer handle;
+ * workers post values by handle and never touch the properties. Posting is
+ * lock free: values are pushed onto an atomic singly linked list, and the GUI
+ * thread takes the whole list with one exchange.
+ *
+ * The queue is drained at most once per frame interval. Only the last value
+ * posted for each handle is applied, and all of them are applied inside one
+ * batch update per property tree. Only the first value posted after a drain
+ * wakes the GUI thread, so the event loop sees one event per frame however
+ * many values arrive.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyUpdateQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QtPropertyUpdateQueue(QObject *parent = NULL);
+
+    /** 未应用的值被丢弃。析构时不能再有线程调用post。*/
+    ~QtPropertyUpdateQueue();
+
+    /** 在GUI线程中注册属性，返回给工作线程使用的句柄。同一属性总是得到同一个句柄。
+     *  属性被delete之后，发给它的值被忽略。句柄不会被重复使用。
+     */
+    int registerProperty(QtProperty *property);
+    QtProperty* getProperty(int handle) const;
+
+    /** 可以在任意线程中调用。*/
+    void post(int handle, const QtPropertyValue &value);
+    void post(int handle, const QVariant &value);
+
+    /** 两次自动应用之间的最短间隔，默认16毫秒。0表示收到值后尽快应用。*/
+    void setFrameInterval(int msec){ frameInterval_ = msec; }
+    int getFrameInterval() const { return frameInterval_; }
+
+public slots:
+    /** 在GUI线程中应用所有已收到的值。也可以由调用者在每一帧开始时调用。*/
+    void drain();
+
+private slots:
+    void onWake();
+
+private:
+    struct Node
+    {
+        Node*               next;
+        int                 handle;
+        QtPropertyValue     value;
+    };
+
+    static void deleteList(Node *node);
+
+    QAtomicPointer<Node>    head_;  ///< 最新的值在最前面
+
+    QVector<QtPropertyPointer> properties_;
+    QHash<QtProperty*, int> handles_;
+
+    /** 每个句柄在本次drain中最后的值，只在drain中使用。*/
+    QVector<Node*>          latest_;
+    QVector<int>            touched_;
+
+    int                     frameInterval_;
+    QElapsedTimer           lastDrain_;
+};
+
+#endif // QTPROPERTYUPDATEQUEUE_H
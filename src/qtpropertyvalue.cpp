@@ -0,0 +1,262 @@
+﻿#include "qtpropertyvalue.h"
+#include "qtpropertytype.h"
+#include "qtpropertybrowserutils.h"
+
+#include <limits>
+#include <new>
+
+QtPropertyValue& QtPropertyValue::operator=(const QtPropertyValue &other)
+{
+    if(this != &other)
+    {
+        clear();
+        assign(other);
+    }
+    return *this;
+}
+
+void QtPropertyValue::clear()
+{
+    if(kind_ == VARIANT)
+    {
+        variant_.~QVariant();
+    }
+    kind_ = NONE;
+    int_ = 0;
+}
+
+void QtPropertyValue::assign(const QtPropertyValue &other)
+{
+    if(other.kind_ == VARIANT)
+    {
+        setVariant(other.variant_);
+    }
+    else
+    {
+        int_ = other.int_;
+        kind_ = other.kind_;
+    }
+}
+
+void QtPropertyValue::setVariant(const QVariant &value)
+{
+    new (&variant_) QVariant(value);
+    kind_ = VARIANT;
+}
+
+QtPropertyValue QtPropertyValue::fromVariant(const QVariant &value, Kind kind)
+{
+    if(!value.isValid())
+    {
+        return QtPropertyValue();
+    }
+
+    bool ok = true;
+    switch(kind)
+    {
+    case INT:
+    {
+        qint64 v = value.toLongLong(&ok);
+        if(ok)
+        {
+            return QtPropertyValue(v);
+        }
+        break;
+    }
+    case DOUBLE:
+    {
+        double v = value.toDouble(&ok);
+        if(ok)
+        {
+            return QtPropertyValue(v);
+        }
+        break;
+    }
+    case BOOL:
+        if(value.canConvert(QVariant::Bool))
+        {
+            return QtPropertyValue(value.toBool());
+        }
+        break;
+    case COLOR:
+        if(value.type() == QVariant::Color)
+        {
+            return QtPropertyValue(value.value<QColor>());
+        }
+        else if(value.type() == QVariant::List && value.toList().size() == 4)
+        {
+            return QtPropertyValue(QtPropertyBrowserUtils::variant2color(value));
+        }
+        break;
+    default:
+        break;
+    }
+
+    QtPropertyValue ret;
+    ret.setVariant(value);
+    return ret;
+}
+
+QtPropertyValue QtPropertyValue::convert(Kind kind) const
+{
+    if(kind_ == kind || kind_ == NONE)
+    {
+        return *this;
+    }
+
+    switch(kind)
+    {
+    case INT:
+        if(kind_ == DOUBLE || kind_ == BOOL)
+        {
+            return QtPropertyValue(toInt());
+        }
+        break;
+    case DOUBLE:
+        if(kind_ == INT || kind_ == BOOL)
+        {
+            return QtPropertyValue(toDouble());
+        }
+        break;
+    case BOOL:
+        if(kind_ == INT || kind_ == DOUBLE)
+        {
+            return QtPropertyValue(toBool());
+        }
+        break;
+    default:
+        break;
+    }
+    return fromVariant(toVariant(), kind);
+}
+
+QVariant QtPropertyValue::toVariant() const
+{
+    switch(kind_)
+    {
+    case INT:
+        if(int_ >= std::numeric_limits<int>::min() && int_ <= std::numeric_limits<int>::max())
+        {
+            return QVariant(int(int_));
+        }
+        return QVariant(qlonglong(int_));
+    case DOUBLE:
+        return QVariant(double_);
+    case BOOL:
+        return QVariant(bool_);
+    case COLOR:
+    {
+        QVariantList val;
+        val.reserve(4);
+        val.push_back(qRed(color_));
+        val.push_back(qGreen(color_));
+        val.push_back(qBlue(color_));
+        val.push_back(qAlpha(color_));
+        return val;
+    }
+    case VARIANT:
+        return variant_;
+    default:
+        return QVariant();
+    }
+}
+
+qint64 QtPropertyValue::toInt() const
+{
+    switch(kind_)
+    {
+    case INT:       return int_;
+    case DOUBLE:    return qint64(double_);
+    case BOOL:      return bool_ ? 1 : 0;
+    case COLOR:     return color_;
+    case VARIANT:   return variant_.toLongLong();
+    default:        return 0;
+    }
+}
+
+double QtPropertyValue::toDouble() const
+{
+    switch(kind_)
+    {
+    case INT:       return double(int_);
+    case DOUBLE:    return double_;
+    case BOOL:      return bool_ ? 1.0 : 0.0;
+    case VARIANT:   return variant_.toDouble();
+    default:        return 0.0;
+    }
+}
+
+bool QtPropertyValue::toBool() const
+{
+    switch(kind_)
+    {
+    case INT:       return int_ != 0;
+    case DOUBLE:    return double_ != 0.0;
+    case BOOL:      return bool_;
+    case VARIANT:   return variant_.toBool();
+    default:        return false;
+    }
+}
+
+QColor QtPropertyValue::toColor() const
+{
+    if(kind_ == COLOR)
+    {
+        return QColor::fromRgba(color_);
+    }
+    else if(kind_ == VARIANT)
+    {
+        return fromVariant(variant_, COLOR).toColor();
+    }
+    return QColor(0, 0, 0);
+}
+
+QString QtPropertyValue::toString() const
+{
+    switch(kind_)
+    {
+    case INT:       return QString::number(int_);
+    case BOOL:      return bool_ ? "true" : "false";
+    case DOUBLE:
+    case COLOR:
+    case VARIANT:   return toVariant().toString();
+    default:        return QString();
+    }
+}
+
+bool QtPropertyValue::operator == (const QtPropertyValue &other) const
+{
+    if(kind_ != other.kind_)
+    {
+        return false;
+    }
+
+    switch(kind_)
+    {
+    case INT:       return int_ == other.int_;
+    case DOUBLE:    return double_ == other.double_;
+    case BOOL:      return bool_ == other.bool_;
+    case COLOR:     return color_ == other.color_;
+    case VARIANT:   return variant_ == other.variant_;
+    default:        return true;
+    }
+}
+
+QtPropertyValue::Kind QtPropertyValue::kindOfType(int type)
+{
+    switch(type)
+    {
+    case QtPropertyType::BOOL:
+        return BOOL;
+    case QtPropertyType::INT:
+    case QtPropertyType::ENUM:
+    case QtPropertyType::FLAG:
+        return INT;
+    case QtPropertyType::FLOAT:
+        return DOUBLE;
+    case QtPropertyType::COLOR:
+        return COLOR;
+    default:
+        return VARIANT;
+    }
+}
@@ -0,0 +1,84 @@
+﻿#ifndef QTPROPERTYVALUE_H
+#define QTPROPERTYVALUE_H
+
+#include "qtpropertyconfig.h"
+#include <QVariant>
+#include <QColor>
+#include <QString>
+
+/**
+ * @brief The QtPropertyValue class
+ *
+ * Small tagged value used as the storage of scalar properties. Integers,
+ * doubles, bools and colours are kept inline and compared directly, any
+ * other value is kept as a QVariant sharing the same storage, so a scalar
+ * value never pays for a QVariant. Conversion from and to QVariant only
+ * happens at the API boundary of QtProperty.
+ */
+class QTPROPERTYSHEET_DLL QtPropertyValue
+{
+public:
+    enum Kind
+    {
+        NONE,       ///< 空值，对应无效的QVariant
+        INT,
+        DOUBLE,
+        BOOL,
+        COLOR,      ///< 打包为QRgb
+        VARIANT,    ///< 其它类型，保存在QVariant中
+    };
+
+    QtPropertyValue() : kind_(NONE) { int_ = 0; }
+    explicit QtPropertyValue(qint64 v) : kind_(INT) { int_ = v; }
+    explicit QtPropertyValue(int v) : kind_(INT) { int_ = v; }
+    explicit QtPropertyValue(double v) : kind_(DOUBLE) { double_ = v; }
+    explicit QtPropertyValue(bool v) : kind_(BOOL) { int_ = 0; bool_ = v; }
+    explicit QtPropertyValue(const QColor &v) : kind_(COLOR) { int_ = 0; color_ = v.rgba(); }
+
+    QtPropertyValue(const QtPropertyValue &other) : kind_(NONE) { int_ = 0; assign(other); }
+    QtPropertyValue& operator=(const QtPropertyValue &other);
+    ~QtPropertyValue(){ clear(); }
+
+    /** 把value转换为kind类型。value无效时得到空值，无法转换时保留原来的QVariant。*/
+    static QtPropertyValue fromVariant(const QVariant &value, Kind kind);
+
+    /** 转换为kind类型，规则同fromVariant。*/
+    QtPropertyValue convert(Kind kind) const;
+
+    /** 生成QVariant。颜色转换为[r, g, b, a]列表，与属性的存储格式一致。*/
+    QVariant toVariant() const;
+
+    Kind getKind() const { return kind_; }
+    bool isNull() const { return kind_ == NONE; }
+
+    qint64 toInt() const;
+    double toDouble() const;
+    bool toBool() const;
+    QColor toColor() const;
+    QString toString() const;
+
+    bool operator == (const QtPropertyValue &other) const;
+    bool operator != (const QtPropertyValue &other) const { return !(*this == other); }
+
+    /** 属性类型对应的存储类型。*/
+    static Kind kindOfType(int type);
+
+private:
+    /** 销毁variant_，变为空值。*/
+    void clear();
+    /** 在空值上复制other。*/
+    void assign(const QtPropertyValue &other);
+    void setVariant(const QVariant &value);
+
+    union
+    {
+        qint64  int_;
+        double  double_;
+        bool    bool_;
+        QRgb    color_;
+        QVariant variant_;  ///< 只在kind_为VARIANT时构造
+    };
+    Kind        kind_;
+};
+
+#endif // QTPROPERTYVALUE_H
@@ -6,6 +6,8 @@
 #include "qtpropertybrowserutils.h"
 
 #include <cassert>
+#include <algorithm>
+#include <QHash>
 #include <QTreeWidget>
 #include <QApplication>
 #include <QItemDelegate>
@@ -26,6 +28,7 @@ QtTreePropertyBrowser::QtTreePropertyBrowser(QObject *parent)
     , editorFactory_(NULL)
     , treeWidget_(NULL)
     , delegate_(NULL)
+    , filterPending_(false)
 {
 
 }
@@ -67,6 +70,8 @@ bool QtTreePropertyBrowser::init(QWidget *parent, QtPropertyEditorFactory *facto
 
     connect(treeWidget_, SIGNAL(currentItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)), this, SLOT(slotCurrentTreeItemChanged(QTreeWidgetItem*,QTreeWidgetItem*)));
     connect(treeWidget_, SIGNAL(destroyed(QObject*)), this, SLOT(slotTreeViewDestroy(QObject*)));
+    connect(treeWidget_, SIGNAL(itemExpanded(QTreeWidgetItem*)), this, SLOT(slotItemExpanded(QTreeWidgetItem*)));
+    connect(treeWidget_, SIGNAL(itemCollapsed(QTreeWidgetItem*)), this, SLOT(slotItemCollapsed(QTreeWidgetItem*)));
     return true;
 }
 
@@ -136,13 +141,20 @@ void QtTreePropertyBrowser::addProperty(QtProperty *property)
         return;
     }
 
+    // changes of all properties arrive through the factory, no connection per property.
+    listenTo(property);
     addProperty(property, NULL);
 }
 
-void QtTreePropertyBrowser::addProperty(QtProperty *property, QTreeWidgetItem *parentItem)
+void QtTreePropertyBrowser::addProperty(QtProperty *property, QTreeWidgetItem *parentItem, QList<QTreeWidgetItem*> *detached)
 {
     QTreeWidgetItem *item = NULL;
-    if(property->isSelfVisible())
+    if(!property->isSelfVisible())
+    {
+        // a hidden property can not be expanded, its children are shown right away.
+        property->populate();
+    }
+    else
     {
         item = new QTreeWidgetItem();
         item->setText(0, property->getTitle());
@@ -154,6 +166,10 @@ void QtTreePropertyBrowser::addProperty(QtProperty *property, QTreeWidgetItem *p
         {
             parentItem->addChild(item);
         }
+        else if(detached != NULL)
+        {
+            detached->push_back(item);
+        }
         else
         {
             treeWidget_->addTopLevelItem(item);
@@ -162,26 +178,38 @@ void QtTreePropertyBrowser::addProperty(QtProperty *property, QTreeWidgetItem *p
         if(property->hasValue())
         {
             item->setIcon(1, property->getValueIcon());
-            item->setText(1, property->getValueString());
+            item->setText(1, valueText(property));
         }
         else
         {
             item->setFirstColumnSpanned(true);
         }
+        updateModified(property, item);
+        updateIndicator(property, item);
+        updateIndex(property);
 
         parentItem = item;
     }
     property2items_[property] = item;
 
-    connect(property, SIGNAL(signalPropertyInserted(QtProperty*,QtProperty*)), this, SLOT(slotPropertyInsert(QtProperty*,QtProperty*)));
-    connect(property, SIGNAL(signalPropertyRemoved(QtProperty*,QtProperty*)), this, SLOT(slotPropertyRemove(QtProperty*,QtProperty*)));
-    connect(property, SIGNAL(signalValueChange(QtProperty*)), this, SLOT(slotPropertyValueChange(QtProperty*)));
-    connect(property, SIGNAL(signalPropertyChange(QtProperty*)), this, SLOT(slotPropertyPropertyChange(QtProperty*)));
+    // add it's children finaly. lazy children are created when the item is expanded.
+    foreach(QtProperty *child, property->getChildren())
+    {
+        addProperty(child, parentItem, detached);
+    }
+}
 
-    // add it's children finaly.
+void QtTreePropertyBrowser::updateSpanned(QtProperty *property)
+{
+    // spanning only works on items that are already in the view.
+    QTreeWidgetItem *item = property2items_.value(property);
+    if(item != NULL && !property->hasValue())
+    {
+        item->setFirstColumnSpanned(true);
+    }
     foreach(QtProperty *child, property->getChildren())
     {
-        addProperty(child, parentItem);
+        updateSpanned(child);
     }
 }
 
@@ -192,19 +220,33 @@ void QtTreePropertyBrowser::removeProperty(QtProperty *property)
     {
         QTreeWidgetItem *item = it.value();
         property2items_.erase(it);
-        disconnect(property, 0, this, 0);
+        forgetItem(property, item);
 
         // remove it's children first.
-        foreach(QtProperty *child, property->getChildren())
-        {
-            removeProperty(child);
-        }
+        removeChildren(property, item == NULL);
 
-        // then remove this QTreeWidgetItem
+        // then remove this QTreeWidgetItem, together with the items below it.
         deleteTreeItem(item);
     }
 }
 
+void QtTreePropertyBrowser::removeChildren(QtProperty *property, bool deleteItems)
+{
+    foreach(QtProperty *child, property->getChildren())
+    {
+        QTreeWidgetItem *item = property2items_.take(child);
+        forgetItem(child, item);
+
+        // a QTreeWidgetItem deletes its children, only the items under a hidden
+        // property have to be deleted one by one.
+        removeChildren(child, deleteItems && item == NULL);
+        if(deleteItems && item != NULL)
+        {
+            deleteTreeItem(item);
+        }
+    }
+}
+
 void QtTreePropertyBrowser::removeAllProperties()
 {
     QList<QtProperty*> properties = property2items_.keys();
@@ -215,6 +257,69 @@ void QtTreePropertyBrowser::removeAllProperties()
     property2items_.clear();
 }
 
+void QtTreePropertyBrowser::onPropertyInsert(QtProperty *property, QtProperty *parent)
+{
+    // the factory reports every property, only follow the ones shown here.
+    if(property2items_.contains(parent))
+    {
+        slotPropertyInsert(property, parent);
+
+        // new items are appended, move it to its place when inserted in the middle.
+        if(parent->indexChild(property) + 1 < parent->getChildren().size())
+        {
+            reorderChildren(parent);
+        }
+    }
+}
+
+void QtTreePropertyBrowser::onPropertyRemove(QtProperty *property, QtProperty *parent)
+{
+    slotPropertyRemove(property, parent);
+}
+
+void QtTreePropertyBrowser::onPropertyValueChange(QtProperty *property)
+{
+    slotPropertyValueChange(property);
+}
+
+void QtTreePropertyBrowser::onPropertyPropertyChange(QtProperty *property)
+{
+    slotPropertyPropertyChange(property);
+}
+
+void QtTreePropertyBrowser::onChildrenInsert(QtProperty *parent, int first, int last)
+{
+    if(!property2items_.contains(parent))
+    {
+        return;
+    }
+
+    // build all the items first, the view is told about them only once.
+    QList<QTreeWidgetItem*> items;
+    for(int i = first; i <= last; ++i)
+    {
+        addProperty(parent->getChildren()[i], NULL, &items);
+    }
+    containerItem(parent)->addChildren(items);
+
+    for(int i = first; i <= last; ++i)
+    {
+        updateSpanned(parent->getChildren()[i]);
+    }
+    if(last + 1 < parent->getChildren().size())
+    {
+        reorderChildren(parent);
+    }
+}
+
+void QtTreePropertyBrowser::onPropertyReorder(QtProperty *parent)
+{
+    if(property2items_.contains(parent))
+    {
+        reorderChildren(parent);
+    }
+}
+
 void QtTreePropertyBrowser::slotPropertyInsert(QtProperty *property, QtProperty *parent)
 {
     QTreeWidgetItem *parentItem = property2items_.value(parent);
@@ -231,8 +336,9 @@ void QtTreePropertyBrowser::slotPropertyValueChange(QtProperty *property)
     QTreeWidgetItem *item = property2items_.value(property);
     if(item != NULL)
     {
-        item->setText(1, property->getValueString());
+        item->setText(1, valueText(property));
         item->setIcon(1, property->getValueIcon());
+        updateIndex(property);
     }
 }
 
@@ -242,7 +348,285 @@ void QtTreePropertyBrowser::slotPropertyPropertyChange(QtProperty *property)
     if(item != NULL)
     {
         item->setText(0, property->getTitle());
-        item->setHidden(!property->isVisible());
+        updateHidden(property, item);
+        updateModified(property, item);
+        updateIndicator(property, item);
+        if(property->hasValue())
+        {
+            item->setText(1, valueText(property));
+        }
+        updateIndex(property);
+    }
+}
+
+QString QtTreePropertyBrowser::valueText(QtProperty *property) const
+{
+    return property->isMixed() ? tr("<mixed>") : property->getValueString();
+}
+
+void QtTreePropertyBrowser::updateModified(QtProperty *property, QTreeWidgetItem *item)
+{
+    bool modified = property->isModified();
+    if(modified != item->font(0).bold())
+    {
+        QFont font = item->font(0);
+        font.setBold(modified);
+        item->setFont(0, font);
+    }
+}
+
+void QtTreePropertyBrowser::updateIndex(QtProperty *property)
+{
+    QString text = property->getTitle() + '\n' + property->getName();
+    if(property->hasValue())
+    {
+        text += '\n' + property->getValueString();
+    }
+    index_.insert(property, text);
+
+    // the row may start or stop matching.
+    if(!filter_.isEmpty())
+    {
+        scheduleFilter();
+    }
+}
+
+void QtTreePropertyBrowser::forgetItem(QtProperty *property, QTreeWidgetItem *item)
+{
+    index_.remove(property);
+    if(item != NULL)
+    {
+        filterShown_.remove(item);
+        filterHidden_.remove(item);
+        filterExpanded_.remove(item);
+    }
+}
+
+void QtTreePropertyBrowser::scheduleFilter()
+{
+    if(!filterPending_)
+    {
+        filterPending_ = true;
+        QMetaObject::invokeMethod(this, "applyFilter", Qt::QueuedConnection);
+    }
+}
+
+void QtTreePropertyBrowser::setFilter(const QString &text)
+{
+    if(text != filter_)
+    {
+        filter_ = text;
+        applyFilter();
+    }
+}
+
+void QtTreePropertyBrowser::updateHidden(QtProperty *property, QTreeWidgetItem *item)
+{
+    bool filtered = !filter_.isEmpty() && !filterShown_.contains(item);
+    if(filtered)
+    {
+        filterHidden_.insert(item);
+    }
+    else
+    {
+        filterHidden_.remove(item);
+    }
+
+    bool hidden = filtered || !property->isVisible();
+    if(hidden != item->isHidden())
+    {
+        item->setHidden(hidden);
+    }
+}
+
+void QtTreePropertyBrowser::applyFilter()
+{
+    filterPending_ = false;
+    if(treeWidget_ == NULL)
+    {
+        return;
+    }
+
+    if(filter_.isEmpty())
+    {
+        // only the rows hidden by the filter are visited.
+        filterShown_.clear();
+        QList<QTreeWidgetItem*> hidden = filterHidden_.toList();
+        foreach(QTreeWidgetItem *item, hidden)
+        {
+            updateHidden(itemToProperty(item), item);
+        }
+
+        // rows the user had collapsed go back to that state.
+        foreach(QTreeWidgetItem *item, filterExpanded_)
+        {
+            item->setExpanded(false);
+        }
+        filterExpanded_.clear();
+        return;
+    }
+
+    filterShown_.clear();
+    foreach(QtProperty *property, index_.find(filter_))
+    {
+        QTreeWidgetItem *item = property2items_.value(property);
+        if(item == NULL || filterShown_.contains(item))
+        {
+            continue;
+        }
+        filterShown_.insert(item);
+
+        // stop at the first ancestor another match has shown already.
+        for(QTreeWidgetItem *parent = item->parent(); parent != NULL && !filterShown_.contains(parent); parent = parent->parent())
+        {
+            filterShown_.insert(parent);
+            if(!parent->isExpanded())
+            {
+                parent->setExpanded(true);
+                filterExpanded_.insert(parent);
+            }
+        }
+    }
+
+    // a row can only be seen when all its ancestors are shown, so only the top
+    // level rows and the children of shown rows have to be updated. rows
+    // below a hidden one keep whatever state they have.
+    QList<QTreeWidgetItem*> rows;
+    QTreeWidgetItem *root = treeWidget_->invisibleRootItem();
+    for(int i = 0; i < root->childCount(); ++i)
+    {
+        rows.push_back(root->child(i));
+    }
+    foreach(QTreeWidgetItem *item, filterShown_)
+    {
+        for(int i = 0; i < item->childCount(); ++i)
+        {
+            rows.push_back(item->child(i));
+        }
+    }
+    foreach(QTreeWidgetItem *item, rows)
+    {
+        updateHidden(itemToProperty(item), item);
+    }
+}
+
+void QtTreePropertyBrowser::updateIndicator(QtProperty *property, QTreeWidgetItem *item)
+{
+    QTreeWidgetItem::ChildIndicatorPolicy policy = property->isPopulated() ?
+                QTreeWidgetItem::DontShowIndicatorWhenChildless : QTreeWidgetItem::ShowIndicator;
+    if(policy != item->childIndicatorPolicy())
+    {
+        item->setChildIndicatorPolicy(policy);
+    }
+}
+
+QTreeWidgetItem* QtTreePropertyBrowser::containerItem(QtProperty *property)
+{
+    while(property != NULL && property2items_.contains(property))
+    {
+        QTreeWidgetItem *item = property2items_.value(property);
+        if(item != NULL)
+        {
+            return item;
+        }
+        property = property->getParent();
+    }
+    return treeWidget_->invisibleRootItem();
+}
+
+void QtTreePropertyBrowser::collectChildItems(QtProperty *property, QList<QTreeWidgetItem*> &items)
+{
+    foreach(QtProperty *child, property->getChildren())
+    {
+        Property2ItemMap::iterator it = property2items_.find(child);
+        if(it == property2items_.end())
+        {
+            continue;
+        }
+
+        if(it.value() != NULL)
+        {
+            items.push_back(it.value());
+        }
+        else
+        {
+            collectChildItems(child, items);
+        }
+    }
+}
+
+static void collectExpandedItems(QTreeWidgetItem *item, QList<QTreeWidgetItem*> &expanded)
+{
+    if(item->isExpanded())
+    {
+        expanded.push_back(item);
+    }
+    for(int i = 0; i < item->childCount(); ++i)
+    {
+        collectExpandedItems(item->child(i), expanded);
+    }
+}
+
+void QtTreePropertyBrowser::reorderChildren(QtProperty *parent)
+{
+    if(treeWidget_ == NULL)
+    {
+        return;
+    }
+
+    QTreeWidgetItem *container = containerItem(parent);
+    QList<QTreeWidgetItem*> items;
+    collectChildItems(parent, items);
+
+    // the rows these items occupy now, they are refilled in the new order.
+    QHash<QTreeWidgetItem*, int> rows;
+    for(int i = 0; i < container->childCount(); ++i)
+    {
+        rows.insert(container->child(i), i);
+    }
+    QVector<int> positions;
+    positions.reserve(items.size());
+    foreach(QTreeWidgetItem *item, items)
+    {
+        positions.push_back(rows.value(item));
+    }
+    std::sort(positions.begin(), positions.end());
+
+    // only the range that actually changed is moved.
+    int first = 0;
+    while(first < items.size() && container->child(positions[first]) == items[first])
+    {
+        ++first;
+    }
+    int last = items.size() - 1;
+    while(last > first && container->child(positions[last]) == items[last])
+    {
+        --last;
+    }
+    if(first >= items.size())
+    {
+        return;
+    }
+
+    // taking an item out drops the expanded state kept by the view.
+    QList<QTreeWidgetItem*> expanded;
+    for(int i = first; i <= last; ++i)
+    {
+        collectExpandedItems(items[i], expanded);
+    }
+
+    for(int i = last; i >= first; --i)
+    {
+        container->takeChild(positions[i]);
+    }
+    for(int i = first; i <= last; ++i)
+    {
+        container->insertChild(positions[i], items[i]);
+    }
+
+    foreach(QTreeWidgetItem *item, expanded)
+    {
+        item->setExpanded(true);
     }
 }
 
@@ -254,6 +638,24 @@ void QtTreePropertyBrowser::slotTreeViewDestroy(QObject *p)
     }
 }
 
+void QtTreePropertyBrowser::slotItemExpanded(QTreeWidgetItem *item)
+{
+    QtProperty *property = itemToProperty(item);
+    if(property != NULL)
+    {
+        lazyExpanded(property);
+    }
+}
+
+void QtTreePropertyBrowser::slotItemCollapsed(QTreeWidgetItem *item)
+{
+    QtProperty *property = itemToProperty(item);
+    if(property != NULL)
+    {
+        lazyCollapsed(property);
+    }
+}
+
 void QtTreePropertyBrowser::deleteTreeItem(QTreeWidgetItem *item)
 {
     if(treeWidget_)
@@ -2,8 +2,10 @@
 #define QTTREEPROPERTYBROWSER_H
 
 #include "qtpropertybrowser.h"
+#include "qtpropertytextindex.h"
 #include <QIcon>
 #include <QMap>
+#include <QSet>
 
 class QWidget;
 class QModelIndex;
@@ -45,6 +47,19 @@ public:
     virtual bool isExpanded(QtProperty *property);
     virtual void setExpanded(QtProperty *property, bool expand);
 
+    /** 只显示标题、名称或值中包含text的属性，以及它们的祖先，不区分大小写。
+     *  空字符串取消过滤。尚未创建的懒加载子属性不参与过滤。
+     */
+    void setFilter(const QString &text);
+    const QString& getFilter() const { return filter_; }
+
+    virtual void onPropertyInsert(QtProperty *property, QtProperty *parent);
+    virtual void onPropertyRemove(QtProperty *property, QtProperty *parent);
+    virtual void onPropertyValueChange(QtProperty *property);
+    virtual void onPropertyPropertyChange(QtProperty *property);
+    virtual void onPropertyReorder(QtProperty *parent);
+    virtual void onChildrenInsert(QtProperty *parent, int first, int last);
+
 public slots:
     void slotCurrentTreeItemChanged(QTreeWidgetItem*, QTreeWidgetItem*);
 
@@ -54,10 +69,42 @@ public slots:
     void slotPropertyPropertyChange(QtProperty *property);
 
     void slotTreeViewDestroy(QObject *p);
+    void slotItemExpanded(QTreeWidgetItem *item);
+    void slotItemCollapsed(QTreeWidgetItem *item);
+
+    /** 按当前过滤条件更新条目的显示。属性变化后会自动延迟调用。*/
+    void applyFilter();
 
 private:
-    void addProperty(QtProperty *property, QTreeWidgetItem *parentItem);
+    /** 为property创建条目。detached不为NULL时，顶层的新条目不挂到树上，而是放入detached，
+     *  以便一次插入。
+     */
+    void addProperty(QtProperty *property, QTreeWidgetItem *parentItem, QList<QTreeWidgetItem*> *detached = NULL);
+    void updateSpanned(QtProperty *property);
+
+    /** 被修改的属性标题显示为粗体。字体保存在item中，绘制时不需要再查询属性。*/
+    void updateModified(QtProperty *property, QTreeWidgetItem *item);
+
+    /** 尚未创建子属性的懒加载属性也显示展开标记。*/
+    void updateIndicator(QtProperty *property, QTreeWidgetItem *item);
+
+    /** 值列的文字，多个对象的值不同时显示为mixed。*/
+    QString valueText(QtProperty *property) const;
+
+    /** 过滤索引中property的文本。*/
+    void updateIndex(QtProperty *property);
+    void forgetItem(QtProperty *property, QTreeWidgetItem *item);
+    void scheduleFilter();
+
+    /** 属性不可见，或者被过滤掉时隐藏条目。*/
+    void updateHidden(QtProperty *property, QTreeWidgetItem *item);
     void deleteTreeItem(QTreeWidgetItem *item);
+    void removeChildren(QtProperty *property, bool deleteItems);
+
+    /** 子属性的条目所在的QTreeWidgetItem。隐藏属性的子属性显示在最近的可见祖先下。*/
+    QTreeWidgetItem* containerItem(QtProperty *property);
+    void collectChildItems(QtProperty *property, QList<QTreeWidgetItem*> &items);
+    void reorderChildren(QtProperty *parent);
 
     QtPropertyEditorFactory*    editorFactory_;
     QtPropertyTreeView*         treeWidget_;
@@ -65,6 +112,13 @@ private:
     QIcon                       expandIcon_;
 
     Property2ItemMap            property2items_;
+
+    QtPropertyTextIndex         index_;
+    QString                     filter_;
+    QSet<QTreeWidgetItem*>      filterShown_;   ///< 匹配的条目及其祖先
+    QSet<QTreeWidgetItem*>      filterHidden_;  ///< 因过滤而隐藏的条目
+    QSet<QTreeWidgetItem*>      filterExpanded_;    ///< 因过滤而展开的祖先，清除过滤时折叠
+    bool                        filterPending_;
 };
 
 #endif // QTTREEPROPERTYBROWSER_H